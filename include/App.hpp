@@ -78,6 +78,7 @@ protected:
 	bool shouldClose();
 
 	void copyMe(const App&);
+	void loadImGuiFont();
 };
 
 extern App* GLOBAL_APP;
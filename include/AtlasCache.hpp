@@ -0,0 +1,108 @@
+/**
+ *  @file AtlasCache.hpp
+ *	@brief Binary cache of rasterized font atlases
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+ 
+/*
+ *	Astrohelion 
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *	
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace astrohelion{
+namespace gui{
+
+/**
+ *	@brief Header at the beginning of every font atlas cache file
+ *	@details All offsets are measured in bytes from the beginning of
+ *	the file and are aligned to 16 bytes.
+ */
+struct AtlasCacheHeader{
+	char magic[8];				//!< File identifier, AtlasCache::MAGIC
+	uint32_t version;			//!< File format version, AtlasCache::VERSION
+	uint32_t bytesPerPixel;		//!< Number of bytes stored for each texel
+	uint64_t key;				//!< Hash of the font source and the parameters the atlas was built with
+	float size;					//!< Size at which the glyphs were rasterized, pixels
+	int32_t width;				//!< Width of the atlas, texels
+	int32_t height;				//!< Height of the atlas, texels
+	uint32_t reserved;			//!< Unused; zero
+	uint64_t texelOffset;		//!< Offset to the texels (rows from the top, no padding between rows)
+	uint64_t metricsOffset;		//!< Offset to the glyph metrics
+	uint64_t metricsSize;		//!< Size of the glyph metrics, bytes
+};
+
+/**
+ *	@brief A memory-mapped cache of a rasterized font atlas and its glyph metrics
+ *	@details The texels are stored exactly as they are uploaded to the GPU, so,
+ *	once mapped, they can be handed to glTexImage2D() directly. The glyph metrics
+ *	are an opaque block whose layout is defined by the code that writes the cache.
+ *	A cache is identified by a key, normally the hash of the font file (see
+ *	hashFile()) combined with the parameters the atlas depends on, and by the size
+ *	the glyphs were rasterized at; a cache written with a different key or size is
+ *	ignored.
+ *	
+ *	Memory mapping is implemented with POSIX functions; on other platforms open()
+ *	always fails and the caller rasterizes the atlas instead.
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+class AtlasCache{
+public:
+	AtlasCache();
+	AtlasCache(const AtlasCache&) = delete;
+	~AtlasCache();
+
+	AtlasCache& operator =(const AtlasCache&) = delete;
+
+	bool open(const char*, uint64_t, float);
+	void close();
+	static void write(const char*, uint64_t, float, int, int, int, const void*, const void*, size_t);
+
+	static std::string getCachePath(const char*, float);
+	static uint64_t hashBytes(const void*, size_t, uint64_t seed = HASH_SEED);
+	static bool hashFile(const char*, uint64_t*);
+
+	int getBytesPerPixel() const;
+	int getHeight() const;
+	const void* getMetrics() const;
+	size_t getMetricsSize() const;
+	const unsigned char* getTexels() const;
+	int getWidth() const;
+
+	static const char MAGIC[8];		//!< Identifies a font atlas cache file
+	static const uint32_t VERSION;	//!< Current file format version
+	static const uint64_t HASH_SEED;	//!< Initial value of hashBytes() (64-bit FNV-1a offset basis)
+protected:
+	void* pData = nullptr;			//!< Pointer to the mapped file
+	size_t dataSize = 0;			//!< Size of the mapped file, bytes
+	AtlasCacheHeader header {};		//!< Copy of the file header
+};
+
+}// End of gui namespace
+}// End of astrohelion namespace
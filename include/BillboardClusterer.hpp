@@ -0,0 +1,131 @@
+/**
+ *  @file BillboardClusterer.hpp
+ *	@brief Zoom-dependent clustering of billboard markers
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+
+/*
+ *	Astrohelion
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace astrohelion{
+namespace gui{
+
+/**
+ *	@brief Merges markers that are too close together on screen into aggregate markers
+ *	@details A bounding volume hierarchy is built once over the world positions
+ *	of the markers; each node stores the number of markers it contains and
+ *	their mean position and color. When the camera changes, update() descends
+ *	the hierarchy only until a node spans less than the minimum separation on
+ *	screen (or a budget of candidates per screen cell is reached), so the cost
+ *	depends on the number of clusters rather than the number of markers. The
+ *	resulting candidates are then binned into a screen grid with cells the
+ *	size of the minimum separation, and the candidates in each cell are
+ *	merged; the number of clusters is therefore bounded by the area of the
+ *	viewport.
+ *	
+ *	The clusters are returned as arrays that can be passed directly to
+ *	BillboardSet::update().
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+class BillboardClusterer{
+public:
+	BillboardClusterer();
+
+	void build(const std::vector<float>&, const std::vector<float>&);
+	void clear();
+	void invalidate();
+	bool update(const glm::mat4&, const glm::mat4&, const glm::vec2&);
+
+	const std::vector<float>& getColors() const;
+	const std::vector<unsigned int>& getCounts() const;
+	float getMarkerRadius() const;
+	float getMinSeparation() const;
+	size_t getNumClusters() const;
+	size_t getNumMarkers() const;
+	const std::vector<float>& getPoints() const;
+	const std::vector<float>& getRadii() const;
+
+	void setMarkerRadius(float);
+	void setMinSeparation(float);
+
+	static const float DEFAULT_MIN_SEPARATION;	//!< Default minimum separation between clusters, pixels
+protected:
+	/**
+	 *	@brief A node of the hierarchy
+	 *	@details Every node covers a contiguous range of the marker order array
+	 */
+	struct Node{
+		glm::vec3 lo {};			//!< Minimum corner of the bounding box of the node, world coordinates
+		glm::vec3 hi {};			//!< Maximum corner of the bounding box of the node, world coordinates
+		glm::vec3 center {};		//!< Mean position of the markers in the node, world coordinates
+		glm::vec4 color {};			//!< Mean color of the markers in the node (RGBA)
+		size_t first = 0;			//!< Index of the first marker of the node in order
+		size_t count = 0;			//!< Number of markers in the node
+		int left = -1;				//!< Index of the left child; -1 for a leaf
+		int right = -1;				//!< Index of the right child; -1 for a leaf
+	};
+
+	/**
+	 *	@brief Sums accumulated for one cell of the screen grid
+	 */
+	struct Cell{
+		glm::vec3 pos {};			//!< Sum of the positions of the markers in the cell, weighted by count
+		glm::vec4 color {};			//!< Sum of the colors of the markers in the cell, weighted by count
+		unsigned int count = 0;		//!< Number of markers in the cell
+	};
+
+	int buildNode(size_t, size_t);
+	glm::vec3 getPosition(size_t) const;
+
+	std::vector<float> markerPoints {};		//!< Positions of the markers (x, y, z for each), world coordinates
+	std::vector<float> markerColors {};		//!< Colors of the markers (RGBA for each)
+	std::vector<size_t> order {};			//!< Marker indices, ordered so that each node covers a contiguous range
+	std::vector<Node> nodes {};				//!< Nodes of the hierarchy; nodes[0] is the root
+
+	std::vector<float> points {};			//!< Position of each cluster (x, y, z), world coordinates
+	std::vector<float> colors {};			//!< Color of each cluster (RGBA)
+	std::vector<float> radii {};			//!< Radius of each cluster, pixels
+	std::vector<unsigned int> counts {};	//!< Number of markers in each cluster
+
+	std::vector<Cell> cells {};				//!< Screen grid; scratch space for update(), reused between updates
+	std::vector<size_t> usedCells {};		//!< Cells that contain at least one candidate
+
+	float minSeparation = DEFAULT_MIN_SEPARATION;	//!< Markers closer than this on screen are merged, pixels
+	float markerRadius = 0;					//!< Radius of a cluster that contains one marker, pixels
+	glm::mat4 lastViewProj {};				//!< View-projection matrix of the most recent update
+	glm::vec2 lastViewport {};				//!< Viewport size of the most recent update, pixels
+	bool bValid = false;					//!< Whether the clusters describe the current markers and view
+};
+
+}// End of gui namespace
+}// End of astrohelion namespace
@@ -31,25 +31,141 @@
 
 #include <vector>
 
+#include "GL/glew.h"
+
+#include "Polyline.hpp"
+#include "Quantize.hpp"
+
 namespace astrohelion{
 namespace gui{
 
+// Forward Declarations
+class Shader;
+
+/**
+ *	@brief Shapes that may be drawn for each billboard
+ */
+enum class BillboardShape_tp {
+	CIRCLE = 0,		//!< Filled circle
+	HEXAGON = 1		//!< Filled hexagon with vertices to the left and right of the center
+};
+
+/**
+ *	@brief A set of screen-aligned markers (billboards) at points in the world
+ *	@details Each billboard is one instance of a four-vertex quad; the corners
+ *	are generated in billboard.vert from gl_VertexID and the shape is cut out of
+ *	the quad by a signed distance function in billboard.frag, so no geometry
+ *	shader is required. Each instance stores only its position, an RGBA8 color,
+ *	and a radius.
+ *
+ *	Markers that move every frame use the dynamic mode (see initDynamic()):
+ *	the instance buffer holds NUM_REGIONS copies of the set, and each frame
+ *	writes to the copy the GPU finished reading longest ago so that update()
+ *	never waits on a draw in flight.
+ *
+ *	Markers at the nodes of a Polyline can read their positions directly from
+ *	the line's vertex buffer (see initFromLine()), so they cost no additional
+ *	vertex memory; every such marker shares one color and radius.
+ */
 class BillboardSet{
 public:
 	BillboardSet();
-	BillboardSet(std::vector<float> points, std::vector<float> colors);
+	BillboardSet(std::vector<float> points, std::vector<float> colors,
+		std::vector<float> radii = std::vector<float>());
 
-	void init();
+	void init(VertexEncoding_tp enc = VertexEncoding_tp::FLOAT32);
+	void initDynamic(size_t);
+	void initFromLine(const Polyline*, size_t first = 0, size_t stride = 1);
+	void initFromLine(const Polyline*, const std::vector<unsigned int>&);
+	void destroy();
 	void draw();
+	void update(size_t, size_t, const float*, const float *colors = nullptr, const float *radii = nullptr);
+
+	size_t getCapacity() const;
+	size_t getNumPoints() const;
+	BillboardShape_tp getShape() const;
+	bool isDynamic() const;
+
+	void setColor(float, float, float, float);
+	void setNumPoints(size_t);
+	void setRadius(float);
+	void setShape(BillboardShape_tp);
+
+	static const float DEFAULT_RADIUS;	//!< Radius of billboards constructed without radii, pixels
+	static const unsigned int NUM_REGIONS = 3;	//!< Number of copies of a dynamic set in the instance buffer
 protected:
+	/**
+	 *	@brief Per-instance data for billboards with 32-bit positions (20 bytes)
+	 */
+	struct Instance{
+		GLfloat pos[3];			//!< Position, world coordinates
+		GLubyte color[4];		//!< Color (RGBA), normalized
+		GLfloat radius;			//!< Radius, pixels
+	};
+
+	/**
+	 *	@brief Per-instance data for billboards with quantized positions (16 bytes)
+	 */
+	struct QuantInstance{
+		GLushort pos[QUANT_STRIDE];	//!< Position within the chunk and chunk index; see quantizePositions()
+		GLubyte color[4];		//!< Color (RGBA), normalized
+		GLfloat radius;			//!< Radius, pixels
+	};
+
+	/**
+	 *	@brief Uniform locations of the "billboard" shader, resolved once per linked program
+	 */
+	struct BillboardUniforms{
+		GLuint program = 0;			//!< Program the locations were resolved for
+		GLint bQuantized = -1;		//!< Whether the positions are quantized
+		GLint shape = -1;			//!< Shape drawn for every billboard
+		GLint chunkTable = -1;		//!< Texture unit of the chunk table
+		GLint bLineNodes = -1;		//!< Whether the billboards mark the nodes of a line
+		GLint lineVertices = -1;	//!< Texture unit of the line vertex buffer
+		GLint bLineIndexed = -1;	//!< Whether the marked nodes are read from the NodeIndex attribute
+		GLint nodeFirst = -1;		//!< Index of the first marked node
+		GLint nodeStride = -1;		//!< Number of nodes between consecutive markers
+	};
 
-	std::vector<float> points {};
-	std::vector<float> vertexData {};
-	std::vector<float> colors {};
+	static BillboardUniforms uniforms;	//!< Uniform locations in the "billboard" shader
+
+	static void resolveUniforms(Shader&);
+
+	void acquireRegion(size_t skipFirst = 0, size_t skipCount = 0);
+	size_t countLineNodes() const;
+	void initQuantized();
+	void packColor(unsigned int, GLubyte*) const;
+	void setInstanceAttribs(GLintptr);
+	void writeInstances(unsigned int, size_t, size_t);
+
+	std::vector<float> points {};	//!< Billboard positions (x, y, z for each billboard), world coordinates
+	std::vector<float> colors {};	//!< Billboard colors (RGBA for each billboard)
+	std::vector<float> radii {};	//!< Billboard radii, pixels
 
 	unsigned int numPoints = 0;		//!< Number of points
+	VertexEncoding_tp encoding = VertexEncoding_tp::FLOAT32;	//!< Format of the positions stored in the VBO
+	BillboardShape_tp shape = BillboardShape_tp::HEXAGON;		//!< Shape drawn for every billboard
 	unsigned int VAO = 0;			//!< Vertex array object
-	unsigned int VBO = 0;			//!< Vertex buffer object
+	unsigned int VBO = 0;			//!< Instance buffer object
+	unsigned int chunkBuffer = 0;	//!< Origin and scale of each chunk of quantized positions
+	unsigned int chunkTexture = 0;	//!< Buffer texture that exposes chunkBuffer to billboard.vert
+
+	bool bDynamic = false;			//!< Whether the set was initialized by initDynamic()
+	size_t capacity = 0;			//!< Number of billboards each region of a dynamic set can store
+	bool bPersistent = false;		//!< Whether the instance buffer uses immutable, persistently mapped storage (ARB_buffer_storage)
+	Instance *pMapped = nullptr;	//!< Persistent mapping of the instance buffer
+	unsigned int region = 0;		//!< Region written by update() and read by draw()
+	bool bRegionOpen = false;		//!< Whether update() has acquired region since the last draw
+	GLsync regionFences[NUM_REGIONS] = {0, 0, 0};	//!< Fence placed after the most recent draw from each region
+	SegmentRange staleRanges[NUM_REGIONS] {};		//!< Billboards updated since each region was last written
+
+	const Polyline *pLine = nullptr;	//!< Line whose vertex buffer stores the positions, if initialized by initFromLine()
+	size_t lineFirst = 0;			//!< Index of the first node marked on pLine
+	size_t lineStride = 1;			//!< Number of nodes between consecutive markers on pLine
+	bool bLineIndexed = false;		//!< Whether the marked nodes are listed in the VBO (one unsigned int per marker)
+	unsigned int lineTexture = 0;	//!< Buffer texture that exposes the vertex buffer of pLine to billboard.vert
+	float markerColor[4] = {1, 1, 1, 1};	//!< Color of every marker on pLine (RGBA)
+	float markerRadius = 0;			//!< Radius of every marker on pLine, pixels
 };
 
 }	// End of astrohelion namespace
@@ -25,6 +25,8 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
+#include "Frustum.hpp"
+
 namespace astrohelion{
 namespace gui{
 
@@ -58,6 +60,7 @@ public:
             glm::vec3 target = glm::vec3(0.f, 0.f, 0.f),
             glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f));
 
+    Frustum getFrustum(const glm::mat4&) const;
     void getViewMatrix(glm::mat4*) const;
     glm::mat4 getViewMatrix() const;
     GLfloat getZoom() const;
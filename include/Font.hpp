@@ -28,22 +28,65 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
-#include <map>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace astrohelion{
 namespace gui{
 // Forward Declarations
-
+class Shader;
 
 struct FontChar{
-	GLuint texID = 0;		//!< ID associated with texture for this glyph
-	glm::ivec2 size;		//!< Width and Height of the character, pixels
-	glm::ivec2 bearing;		//!< horizontal and vertical bearing (position relative to origin/baseline), pixels
-	GLuint advance = 0;		//!< horizontal advance to next glyph, in 1/64 pixels (face->glyph->advance.x)
+	glm::vec2 uvMin {};		//!< Texture coordinates of the top-left corner of the glyph in the atlas
+	glm::vec2 uvMax {};		//!< Texture coordinates of the bottom-right corner of the glyph in the atlas
+	glm::ivec2 size {};		//!< Width and Height of the glyph's distance field, atlas pixels
+	glm::ivec2 bearing {};	//!< horizontal and vertical bearing of the distance field (position relative to origin/baseline), atlas pixels
+	GLuint advance = 0;		//!< horizontal advance to next glyph, in 1/64 atlas pixels (face->glyph->advance.x)
+};
+
+/**
+ *	@brief Counters that describe the effectiveness of the glyph atlas
+ */
+struct GlyphCacheStats{
+	size_t hits = 0;			//!< Glyph lookups satisfied by the atlas
+	size_t misses = 0;			//!< Glyph lookups that required rasterizing the glyph
+	size_t evictions = 0;		//!< Glyphs removed from the atlas to make room for another
+	size_t numSlots = 0;		//!< Number of glyphs the atlas can hold
+	size_t numResident = 0;		//!< Number of glyphs currently in the atlas
+};
+
+/**
+ *	@brief One string of retained text that is made of several strings
+ */
+struct TextRun{
+	std::string str {};		//!< Text (UTF-8)
+	glm::vec2 origin {};	//!< Bottom-left corner of the text relative to the position passed to Font::drawText(), pixels
+	GLfloat scale = 1;		//!< Scaling factor for the font
+	glm::vec3 color {};		//!< RGB normalized color vector (values 0 - 1)
 };
 
 /**
  *	@brief Load fonts and render text
+ *	@details Every glyph is stored as a signed distance field in a single
+ *	atlas texture, rendered once at a fixed resolution; text.frag reconstructs
+ *	sharp edges from the distance field at any scale. The atlas has a fixed
+ *	number of equal slots. Glyphs are rasterized when they are first used
+ *	(text is UTF-8), and the least recently used glyph is evicted when the
+ *	atlas is full; printable ASCII is loaded up front. The preloaded atlas
+ *	is written to an AtlasCache next to the font file and mapped by later
+ *	runs, and every Font shares one FreeType library and one face per file.
+ *
+ *	Text that changes every frame is queued with queueText(), which appends
+ *	one quad per character to a CPU-side batch, and the whole batch is drawn
+ *	with one call by flush(); renderText() queues and flushes a single string.
+ *	Text that rarely changes is laid out once into its own vertex buffer by
+ *	createText(), which returns a handle; drawText() then draws it with one
+ *	call, at any position, and the layout is only rebuilt when updateText()
+ *	changes it. Retained text may also be made of many strings (TextRun), each
+ *	at its own position, so that a set of labels costs one draw call.
  *
  *	@author Andrew Cox
  *	@version September 22, 2016
@@ -58,24 +101,76 @@ public:
 
 	const Font& operator =(const Font&);
 
-	void initFont(const char*, float);
-	void renderText(std::string, GLfloat, GLfloat);
-	void renderText(std::string, GLfloat, GLfloat, GLfloat, glm::vec3);
-
+	void initFont(const char*, float, int atlasSize = DEFAULT_ATLAS_SIZE);
+	void queueText(const std::string&, GLfloat, GLfloat, GLfloat, glm::vec3);
+	void flush();
+	void renderText(const std::string&, GLfloat, GLfloat);
+	void renderText(const std::string&, GLfloat, GLfloat, GLfloat, glm::vec3);
+
+	int createText(const std::string&, GLfloat, glm::vec3);
+	int createText(const std::vector<TextRun>&);
+	void destroyText(int);
+	void drawText(int, GLfloat, GLfloat);
+	void updateText(int, const std::string&, GLfloat, glm::vec3);
+	void updateText(int, const std::vector<TextRun>&);
+
+	GlyphCacheStats getGlyphStats() const;
+	size_t getNumQueuedGlyphs() const;
+	void measureText(const std::string&, GLfloat, glm::vec2*, glm::vec2*);
+	void resetGlyphStats();
 	void updateWindow(GLFWwindow*);
 
+	static const int DEFAULT_ATLAS_SIZE = 1024;	//!< Default width and height of the glyph atlas, pixels
 protected:
+	struct GlyphCache;
+
+	/**
+	 *	@brief Text laid out once by createText() and drawn by drawText()
+	 */
+	struct RetainedText{
+		std::vector<TextRun> runs {};	//!< Strings that make up the text
+		std::vector<std::pair<int, unsigned long> > glyphs {};	//!< Atlas slot of each glyph and the generation of the slot when laid out
+		GLuint VAO = 0;				//!< Vertex array for the quads
+		GLuint VBO = 0;				//!< Vertex buffer for the quads, relative to the origin of the text
+		GLsizei numVerts = 0;		//!< Number of vertices in VBO
+		bool bActive = false;		//!< Whether the handle is in use
+	};
+
+	/**
+	 *	@brief Uniform locations of the "font" shader, resolved once per linked program
+	 */
+	struct FontUniforms{
+		GLuint program = 0;		//!< Program the locations were resolved for
+		GLint text = -1;		//!< Texture unit of the glyph atlas
+		GLint offset = -1;		//!< Translation applied to every vertex, pixels
+	};
+
+	static FontUniforms uniforms;	//!< Uniform locations in the "font" shader
+
+	static void resolveUniforms(Shader&);
+
 	void copyMe(const Font&);
+	const FontChar& getGlyph(char32_t, int *pSlot = nullptr);
 	void init();
 	void initProjection();
+	void layoutText(const std::string&, GLfloat, GLfloat, GLfloat, glm::vec3, std::vector<GLfloat>&,
+		std::vector<std::pair<int, unsigned long> >*);
+	void layoutRetained(RetainedText&);
+	int loadGlyph(char32_t);
+	void writeAtlasCache(const char*, uint64_t) const;
 
 	GLuint VAO = 0;		//!< Vertex array for font data
 	GLuint VBO = 0;		//!< Vertex buffer for font data
+	GLuint atlasTex = 0;	//!< Texture that stores the distance field of every glyph (one byte per texel, in the red component)
+	float glyphScale = 1;	//!< Screen pixels per atlas pixel at a text scale of one
+	size_t vboCapacity = 0;	//!< Number of floats the VBO can store without reallocation
 
 	int viewW = 800;	//!< Width of the viewport, pixels
 	int viewH = 600;	//!< Height of the viewport, pixels
 
-	std::map<GLchar, FontChar> characters {};	//!< Map of data objects that store the texture ID and size of various glyphs
+	std::shared_ptr<GlyphCache> pGlyphs = nullptr;	//!< FreeType face and the glyphs in the atlas; shared by copies
+	std::vector<GLfloat> batch {};			//!< Queued vertices (x, y, u, v, r, g, b for each), six per glyph
+	std::vector<RetainedText> texts {};		//!< Retained text, indexed by handle
 private:
 
 };
@@ -0,0 +1,59 @@
+/**
+ *  @file Frustum.hpp
+ *	@brief A view frustum used to cull geometry on the CPU
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+
+/*
+ *	Astrohelion
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace astrohelion{
+namespace gui{
+
+/**
+ *	@brief The six planes that bound the volume visible to a camera
+ *	@details Each plane is stored as (a, b, c, d) such that a point p is on
+ *	the inner side of the plane if a*p.x + b*p.y + c*p.z + d >= 0.
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+class Frustum{
+public:
+	Frustum();
+	explicit Frustum(const glm::mat4&);
+
+	bool contains(const glm::vec3&, const glm::vec3&) const;
+	bool intersects(const glm::vec3&, const glm::vec3&) const;
+
+protected:
+	glm::vec4 planes[6];	//!< Left, right, bottom, top, near, and far planes, world coordinates
+};
+
+}// End of gui namespace
+}// End of astrohelion namespace
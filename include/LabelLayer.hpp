@@ -0,0 +1,130 @@
+/**
+ *  @file LabelLayer.hpp
+ *	@brief Text labels anchored to world positions, decluttered on screen
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+
+/*
+ *	Astrohelion
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Font.hpp"
+
+namespace astrohelion{
+namespace gui{
+
+/**
+ *	@brief Draws text labels at the projected positions of world anchor points
+ *	@details When the camera changes, update() projects every anchor in one
+ *	pass and then places the labels in order of decreasing priority (labels
+ *	with equal priority keep the order they were added in). A label is dropped
+ *	if its box on screen overlaps a label that has already been placed; the
+ *	placed boxes are binned into a screen grid so that each test only visits
+ *	the boxes in the cells the label covers. The surviving labels are laid
+ *	out once per placement into a single retained Font text, which draw()
+ *	draws with one call.
+ *	
+ *	The placement is reused until the view, the viewport, or the labels
+ *	change, so a still camera costs only the draw.
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+class LabelLayer{
+public:
+	LabelLayer(Font *pFont = nullptr);
+	LabelLayer(const LabelLayer&) = delete;
+	~LabelLayer();
+
+	LabelLayer& operator =(const LabelLayer&) = delete;
+
+	int addLabel(const glm::vec3&, const std::string&, float priority = 0,
+		const glm::vec3 &color = glm::vec3(1.f, 1.f, 1.f), float scale = 1.f);
+	void clear();
+	void draw();
+	void invalidate();
+	void reserve(size_t);
+	bool update(const glm::mat4&, const glm::mat4&, const glm::vec2&);
+
+	Font* getFont() const;
+	size_t getNumLabels() const;
+	size_t getNumVisible() const;
+	glm::vec2 getOffset() const;
+	float getPadding() const;
+	const std::vector<unsigned int>& getVisible() const;
+
+	void setFont(Font*);
+	void setOffset(const glm::vec2&);
+	void setPadding(float);
+
+	static const float DEFAULT_PADDING;	//!< Default minimum gap between labels, pixels
+protected:
+	/**
+	 *	@brief Text and appearance of a label
+	 */
+	struct Label{
+		std::string text {};		//!< Text (UTF-8)
+		glm::vec3 color {};			//!< RGB color
+		float scale = 1;			//!< Scaling factor for the font
+		float priority = 0;			//!< Labels with higher priority are placed first
+		glm::vec2 boxMin {};		//!< Bottom-left corner of the text relative to its origin, pixels
+		glm::vec2 boxMax {};		//!< Top-right corner of the text relative to its origin, pixels
+		bool bMeasured = false;		//!< Whether boxMin and boxMax describe the text in the current font
+	};
+
+	void sortLabels();
+	void uploadText();
+
+	Font *pFont = nullptr;					//!< Font the labels are measured and drawn with; not owned
+
+	std::vector<float> anchors {};			//!< Anchor of each label (x, y, z), world coordinates
+	std::vector<Label> labels {};			//!< Text of each label, in the same order as anchors
+	std::vector<unsigned int> order {};		//!< Label indices by decreasing priority
+	bool bSorted = true;					//!< Whether order is up to date
+
+	std::vector<glm::vec2> screenPos {};	//!< Projected anchor of each label, pixels; scratch space for update()
+	std::vector<std::vector<unsigned int> > cells {};	//!< Placed boxes in each cell of the screen grid
+	std::vector<size_t> usedCells {};		//!< Cells that contain at least one box
+	std::vector<glm::vec4> boxes {};		//!< Screen box of each visible label (min x, min y, max x, max y), pixels
+
+	std::vector<unsigned int> visible {};	//!< Labels placed by the most recent update, in placement order
+	std::vector<TextRun> runs {};			//!< Text and origin of each visible label; scratch space for update()
+	int textHandle = -1;					//!< Retained text of the visible labels in pFont; -1 if not created
+
+	glm::vec2 offset {6.f, 6.f};			//!< Position of the text origin relative to the projected anchor, pixels
+	float padding = DEFAULT_PADDING;		//!< Minimum gap between the boxes of two labels, pixels
+	glm::mat4 lastViewProj {};				//!< View-projection matrix of the most recent update
+	glm::vec2 lastViewport {};				//!< Viewport size of the most recent update, pixels
+	bool bValid = false;					//!< Whether the visible labels describe the current labels and view
+};
+
+}// End of gui namespace
+}// End of astrohelion namespace
@@ -37,9 +37,18 @@
 
 #include <imgui/imgui.h>
 
+#include <memory>
+
+#include "BillboardClusterer.hpp"
 #include "BillboardSet.hpp"
 #include "CameraFPS.hpp"
+#include "Font.hpp"
+#include "LabelLayer.hpp"
 #include "Polyline.hpp"
+#include "PolylineBatch.hpp"
+#include "SceneBVH.hpp"
+#include "SceneImporter.hpp"
+#include "TrajLoader.hpp"
 #include "Window.hpp"
 
 namespace astrohelion{
@@ -61,15 +70,56 @@ public:
     void handleWindowSizeEvent(int, int) override;
     
 protected:
+    void rebuildNodeLabels();
+    void rebuildSceneIndex();
+    void updateLoading();
+    void updateSceneImport();
+    void startSceneImport();
 
     Polyline line;
     BillboardSet bill;
+    BillboardSet nodeBill;              //!< Markers at the nodes of line, read from the line's vertex buffer
+    bool bNodeMarkers = false;          //!< Whether nodeBill is drawn
+    int nodeMarkerStride = 100;         //!< Number of nodes between consecutive node markers
+
+    std::unique_ptr<Font> pLabelFont = nullptr; //!< Font for the node and cluster labels; created by init()
+    LabelLayer nodeLabels;              //!< Epoch labels at the nodes of line, every nodeMarkerStride nodes
+    bool bNodeLabels = false;           //!< Whether nodeLabels is drawn
+
+    TrajLoader loader;                  //!< Loads the trajectory on a worker thread
+    bool bLineReserved = false;         //!< Whether space has been reserved in the line for the full trajectory
+    bool bLoadComplete = false;         //!< Whether the trajectory has been completely uploaded
+    int maxChunksPerFrame = 4;          //!< Maximum number of loaded chunks to upload each frame
+
+    SceneImporter importer;             //!< Imports a directory of trajectories in parallel
+    PolylineBatch sceneLines;           //!< Lines imported by the importer, drawn with one call
+    BillboardSet sceneBill;             //!< Markers for the imported lines
+    BillboardClusterer sceneClusters;   //!< Clusters of the markers for the imported lines
+    BillboardSet clusterBill;           //!< Clusters of sceneBill, drawn instead of sceneBill if bClusterMarkers
+    bool bClusterMarkers = true;        //!< Whether markers that overlap on screen are merged
+    LabelLayer clusterLabels;           //!< Number of markers in each cluster of clusterBill that merges more than one
+    float clusterSeparation = BillboardClusterer::DEFAULT_MIN_SEPARATION;   //!< Minimum separation between clusters, pixels
+    bool bSceneReported = true;         //!< Whether the import report has been printed
+    char scenePathBuf[256] = "../data"; //!< Directory to import, edited through the GUI
+
+    SceneBVH sceneIndex;                //!< Bounds of every line in the scene, for frustum culling
+    int lineIndexID = -1;               //!< ID of line in sceneIndex; -1 if it is not indexed
+    std::vector<int> sceneIndexIDs {};  //!< ID in sceneIndex of each line in sceneLines
+    bool bUseCulling = true;            //!< Whether lines are culled against the view frustum on the CPU
 
 	ImVec4 imgui_clearColor = ImColor(114, 144, 154);
 
     CameraFPS camera;
 
     int cameraOptionRadio = 0;  // Tracks which radio button is selected
+    int lineRenderRadio = 0;    //!< Tracks which line render mode is selected
+    bool bUseLOD = true;        //!< Whether the line is drawn at a reduced level of detail when zoomed out
+
+    bool bTimeWindow = false;       //!< Whether only the part of the line within a time window is drawn
+    bool bFadeTrail = true;         //!< Whether the line fades out with age inside the time window
+    float timeWindowEnd = 1.f;      //!< End of the time window, fraction of the trajectory time of flight
+    float timeWindowLength = 0.1f;  //!< Length of the time window, fraction of the trajectory time of flight
+    BillboardSet headBill;          //!< Marker at the head of the time window, moved every frame
 
     GLuint VBO, VAO;
 };
@@ -29,38 +29,184 @@
 
 #pragma once
 
+#include <cstddef>
+#include <memory>
 #include <vector>
 
+#include "GL/glew.h"
+#include <glm/glm.hpp>
+
+#include "Quantize.hpp"
+
 namespace astrohelion{
 namespace gui{
 
+// Forward Declarations
+class Shader;
+class TrajCache;
+
+/**
+ *	@brief Methods that can be used to expand a Polyline into thick triangles
+ */
+enum class LineRender_tp {
+	GEOMETRY_SHADER,	//!< GL_LINES_ADJACENCY primitives expanded by line_thick.geom
+	VERTEX_PULL			//!< GL_TRIANGLES expanded by line_thick_pull.vs; no geometry shader
+};
+
+/**
+ *	@brief A simplified version of a line used when the full resolution is not visible
+ */
+struct LineLOD{
+	float tolerance = 0;	//!< Maximum distance between the simplified and full lines, world units
+	size_t firstIndex = 0;	//!< Offset of the level in the LOD index array
+	size_t numIndices = 0;	//!< Number of indices (four per segment) in the level
+};
+
+/**
+ *	@brief A contiguous range of line segments; segment s joins points s and s+1
+ */
+struct SegmentRange{
+	SegmentRange(size_t f = 0, size_t c = 0) : first(f), count(c) {}
+
+	size_t first;	//!< Index of the first segment
+	size_t count;	//!< Number of segments
+};
+
 class Polyline{
 public:
 	Polyline();
 	Polyline(std::vector<float>);
 
+	void createFromCache(std::shared_ptr<const TrajCache>);
+	void createFromData(std::vector<float>&);
 	void createFromPoints(std::vector<float>);
+	void createQuantized(const std::vector<float>&, size_t chunkSize = QUANT_CHUNK_SIZE);
+	void destroy();
+	void append(const std::vector<float>&);
+	void reserve(size_t);
+	void updateRange(size_t, const std::vector<float>&);
+
+	void buildLOD();
+	void clearLOD();
+	void clearVisibleRanges();
+	void setLOD(const std::vector<LineLOD>&, const std::vector<unsigned int>&);
+	void selectLOD(const glm::mat4&, const glm::mat4&, float);
 
 	void draw();
+	void draw(double, double);
+	bool findTimeRange(double, double, size_t*, size_t*) const;
 
-	const std::vector<float>& getPointsRef();
+	size_t getNumDrawnPoints() const;
+	size_t getNumPoints() const;
+	int getLODLevel() const;
+	size_t getNumLODLevels() const;
+	VertexEncoding_tp getEncoding() const;
+	unsigned int getChunkBuffer() const;
+	const std::vector<double>& getEpochs() const;
+	glm::vec3 getPoint(size_t) const;
+	LineRender_tp getRenderMode() const;
+	const float* getPointsPtr() const;
+	unsigned int getVBO() const;
 	
 	void setColor(float, float, float, float);
+	void setEpochs(const std::vector<double>&);
+	void setFadeAge(double);
+	void setLODLevel(int);
+	void setMaxPixelError(float);
+	void setRenderMode(LineRender_tp);
 	void setThickness(float);
+	void setVisibleRanges(const std::vector<SegmentRange>&);
+
+	static void buildVertexData(const std::vector<float>&, std::vector<float>&);
+	static void computeLOD(const float*, size_t, std::vector<LineLOD>&, std::vector<unsigned int>&);
+
+	static const unsigned int VERTEX_STRIDE;	//!< Number of floats stored for each vertex (position)
+	static const float DEFAULT_COLOR[4];		//!< Default line color
 protected:
+	/**
+	 *	@brief Uniform locations of a thick line shader, resolved once per linked program
+	 *	@details Uniforms that the program does not declare keep a location of -1
+	 */
+	struct LineUniforms{
+		GLuint program = 0;			//!< Program the locations were resolved for
+		GLint thickness = -1;		//!< Line thickness, pixels
+		GLint miterLimit = -1;		//!< Dot product below which a corner is beveled
+		GLint lineColor = -1;		//!< Line color (RGBA)
+		GLint bFade = -1;			//!< Whether the line fades out by age
+		GLint fadeEnd = -1;			//!< Epoch at which the age is zero
+		GLint fadeAge = -1;			//!< Age at which the line is fully transparent
+		GLint bQuantized = -1;		//!< Whether the positions are quantized; "line_thick" only
+		GLint chunkTable = -1;		//!< Texture unit of the chunk table; "line_thick" only
+		GLint vertexData = -1;		//!< Texture unit of the vertex buffer; "line_thick_pull" only
+		GLint vertexStride = -1;	//!< Floats per vertex; "line_thick_pull" only
+		GLint indexData = -1;		//!< Texture unit of the LOD index buffer; "line_thick_pull" only
+		GLint bIndexed = -1;		//!< Whether the vertices are read through indexData; "line_thick_pull" only
+		GLint indexOffset = -1;		//!< First index of the LOD level; "line_thick_pull" only
+		GLint epochData = -1;		//!< Texture unit of the epoch buffer; "line_thick_pull" only
+	};
+
+	static LineUniforms geomUniforms;	//!< Uniform locations in the "line_thick" shader
+	static LineUniforms pullUniforms;	//!< Uniform locations in the "line_thick_pull" shader
+
+	static void resolveUniforms(Shader&, bool, LineUniforms*);
+
+	void allocateBuffers(size_t, GLenum);
+	void clearEpochs();
+	void detachCache();
+	void detachQuantized();
+	void drawSegments(const std::vector<SegmentRange>&, const LineLOD*, bool, float);
+	void initVAO();
+	void pushVertex(float, float, float);
+	void releaseBuffers();
+	void uploadEpochs();
+
+	std::vector<float> vertices {};	//!< Adjacency vertex, points, adjacency vertex (x, y, z for each)
+	size_t numPoints = 0;			//!< Number of points stored in vertices
 
-	std::vector<float> points {};
-	std::vector<float> vertices {};
-	std::vector<unsigned int> indices {};
+	size_t capacity = 0;		//!< Number of points the GPU buffers can store without reallocation
+
+	bool bPersistent = false;	//!< Whether the GPU buffers use immutable, persistently mapped storage (ARB_buffer_storage)
+	float *pMappedVerts = nullptr;	//!< Persistent mapping of the vertex buffer
+
+	std::shared_ptr<const TrajCache> pCache = nullptr;	//!< Cache the GPU data was uploaded from, if any
+
+	VertexEncoding_tp encoding = VertexEncoding_tp::FLOAT32;	//!< Format of the positions stored in the VBO
+	std::vector<unsigned short> qVertices {};	//!< Quantized vertices (see quantizePositions()); used instead of vertices
+	std::vector<float> chunkTable {};		//!< Origin and scale of each chunk of qVertices
 
 	float thickness = 7.f;
 	float miterLimit = 0.75f;
 
-	float color[4] = {0.9, 0.9, 0.9, 1.0};
+	LineRender_tp renderMode = LineRender_tp::GEOMETRY_SHADER;	//!< Method used to expand the line
+
+	std::vector<LineLOD> lodLevels {};		//!< Simplified levels, ordered from finest to coarsest
+	int lodLevel = -1;						//!< Index of the level drawn by draw(); -1 draws the full line
+	float maxPixelError = 0.5f;				//!< Largest screen-space error allowed when a level is selected, pixels
+	glm::vec3 boundsMin {};					//!< Minimum corner of the bounding box of the line, world coordinates
+	glm::vec3 boundsMax {};					//!< Maximum corner of the bounding box of the line, world coordinates
+
+	std::vector<SegmentRange> visibleRanges {};	//!< Segments drawn by draw() at full resolution if bCulled
+	bool bCulled = false;					//!< Whether draw() is limited to visibleRanges
+
+	float color[4] = {0.9, 0.9, 0.9, 1.0};	//!< Line color (RGBA), passed to the shader as a uniform
+
+	std::vector<double> epochs {};			//!< Epoch of each point; empty if the epochs are unknown
+	bool bEpochsDescending = false;			//!< Whether the epochs decrease along the line (e.g., propagated backward in time)
+	double fadeAge = 0;						//!< Age at which draw(t0, t1) fades the line out completely; zero disables the fade
 
 	unsigned int VAO = 0;
 	unsigned int VBO = 0;
-	unsigned int EBO = 0;
+	unsigned int pullTexture = 0;		//!< Buffer texture that exposes the VBO to line_thick_pull.vs
+	unsigned int pullTextureVBO = 0;	//!< VBO currently attached to pullTexture
+	unsigned int lodEBO = 0;			//!< Index buffer that stores every LOD level; bound to the VAO
+	unsigned int lodTexture = 0;		//!< Buffer texture that exposes lodEBO to line_thick_pull.vs
+	unsigned int lodTextureEBO = 0;		//!< Buffer currently attached to lodTexture
+	unsigned int chunkBuffer = 0;		//!< Buffer that stores chunkTable
+	unsigned int chunkTexture = 0;		//!< Buffer texture that exposes chunkBuffer to line_thick.vs
+	unsigned int chunkTextureBuffer = 0;	//!< Buffer currently attached to chunkTexture
+	unsigned int epochVBO = 0;			//!< Epoch of each vertex relative to the first point; attribute location 1
+	unsigned int epochTexture = 0;		//!< Buffer texture that exposes epochVBO to line_thick_pull.vs
+	unsigned int epochTextureVBO = 0;	//!< Buffer currently attached to epochTexture
 };
 
 }	// End of astrohelion namespace
@@ -0,0 +1,155 @@
+/**
+ *  @file PolylineBatch.hpp
+ *	@brief Draw many lines with a single draw call
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+ 
+/*
+ *	Astrohelion 
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *	
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "GL/glew.h"
+
+#include "Polyline.hpp"
+
+namespace astrohelion{
+namespace gui{
+
+// Forward Declarations
+class Shader;
+
+/**
+ *	@brief A set of lines that share one vertex buffer, one index buffer, and one draw call
+ *	@details Each line in the batch is drawn with the same thick-line geometry
+ *	shader used by Polyline. Every vertex stores the index of its line; the color
+ *	and thickness of each line are looked up from a buffer texture by that index,
+ *	so the style of a line can be changed without touching the geometry. Lines
+ *	that are visible and adjacent in the index buffer are merged into a single
+ *	range, and all ranges are submitted with one glMultiDrawElements() call.
+ *	
+ *	All functions that modify the GPU data do so lazily; the buffers are updated
+ *	by draw(), which must be called from the thread that owns the OpenGL context.
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+class PolylineBatch{
+public:
+	PolylineBatch();
+
+	int addLine(const std::vector<float>&, const float *rgba = Polyline::DEFAULT_COLOR, float thickness = 7.f);
+	int addLine(const float*, size_t, const float *rgba = Polyline::DEFAULT_COLOR, float thickness = 7.f);
+	void clear();
+	void clearVisibleRanges();
+	void destroy();
+	void draw();
+
+	size_t getNumLines() const;
+	size_t getNumPoints() const;
+	size_t getNumPoints(int) const;
+	size_t getNumRanges();
+	const float* getPointsPtr(int) const;
+	
+	void setColor(int, float, float, float, float);
+	void setMiterLimit(float);
+	void setThickness(int, float);
+	void setVisible(int, bool);
+	void setVisibleRanges(int, const std::vector<SegmentRange>&);
+
+	static const unsigned int STYLE_TEXELS;		//!< Number of RGBA texels in the style buffer for each line
+	static const unsigned int POINT_STRIDE;		//!< Number of floats between consecutive points returned by getPointsPtr()
+protected:
+	/**
+	 *	@brief Vertex layout in the shared vertex buffer
+	 */
+	struct BatchVertex{
+		GLfloat pos[3];			//!< Position, world coordinates
+		GLint lineID;			//!< Index of the line the vertex belongs to
+	};
+
+	/**
+	 *	@brief Location of one line within the shared index buffer
+	 */
+	struct LineRange{
+		size_t firstIndex = 0;	//!< Index of the first element in the index buffer
+		GLsizei numIndices = 0;	//!< Number of elements in the index buffer
+		size_t firstVertex = 0;	//!< Index of the leading adjacency vertex in the vertex buffer
+		size_t numPoints = 0;	//!< Number of points in the line
+		bool bVisible = true;	//!< Whether or not the line is drawn
+		bool bCulled = false;	//!< Whether only visibleRanges of the line are drawn
+		std::vector<SegmentRange> visibleRanges {};	//!< Segments drawn if bCulled
+	};
+
+	/**
+	 *	@brief Uniform locations of the "line_batch" shader, resolved once per linked program
+	 */
+	struct BatchUniforms{
+		GLuint program = 0;		//!< Program the locations were resolved for
+		GLint miterLimit = -1;	//!< Dot product below which a corner is beveled
+		GLint lineStyles = -1;	//!< Texture unit of the style buffer
+	};
+
+	static BatchUniforms uniforms;	//!< Uniform locations in the "line_batch" shader
+
+	static void resolveUniforms(Shader&);
+
+	void checkID(int) const;
+	void initBuffers();
+	void markStyleDirty(int);
+	void updateDrawList();
+	void uploadGeometry();
+	void uploadStyles();
+
+	std::vector<BatchVertex> vertices {};		//!< CPU copy of the shared vertex buffer
+	std::vector<GLuint> indices {};				//!< CPU copy of the shared index buffer
+	std::vector<GLfloat> styles {};				//!< CPU copy of the style buffer; STYLE_TEXELS RGBA texels per line
+	std::vector<LineRange> lines {};			//!< Location of each line in the index buffer
+
+	std::vector<GLsizei> drawCounts {};			//!< Element count of each range passed to glMultiDrawElements()
+	std::vector<const GLvoid*> drawOffsets {};	//!< Byte offset of each range passed to glMultiDrawElements()
+	bool bDrawListDirty = true;					//!< Whether the draw ranges must be rebuilt
+
+	size_t numUploadedVerts = 0;	//!< Number of vertices already copied to the GPU
+	size_t numUploadedIndices = 0;	//!< Number of indices already copied to the GPU
+	size_t vertCapacity = 0;		//!< Number of vertices the vertex buffer can store
+	size_t indexCapacity = 0;		//!< Number of indices the index buffer can store
+	size_t styleCapacity = 0;		//!< Number of lines the style buffer can store
+	size_t styleDirtyBegin = 0;		//!< First line whose style must be uploaded
+	size_t styleDirtyEnd = 0;		//!< One past the last line whose style must be uploaded
+
+	float miterLimit = 0.75f;		//!< Miter limit applied to every line
+
+	GLuint VAO = 0;					//!< Vertex array object
+	GLuint VBO = 0;					//!< Shared vertex buffer
+	GLuint EBO = 0;					//!< Shared index buffer
+	GLuint styleBuffer = 0;			//!< Buffer that stores the line styles
+	GLuint styleTexture = 0;		//!< Buffer texture that exposes styleBuffer to the shader
+};
+
+}	// End of gui namespace
+}	// End of astrohelion namespace
@@ -0,0 +1,62 @@
+/**
+ *  @file Quantize.hpp
+ *	@brief Compact, relative-origin encoding of vertex positions
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+
+/*
+ *	Astrohelion
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace astrohelion{
+namespace gui{
+
+/**
+ *	@brief Formats used to store vertex positions on the GPU
+ */
+enum class VertexEncoding_tp {
+	FLOAT32,		//!< Three 32-bit floats per position, world coordinates
+	QUANTIZED16		//!< Three 16-bit normalized offsets from the origin of a chunk, plus a 16-bit chunk index
+};
+
+/** Number of unsigned shorts stored for each quantized position (x, y, z, chunk) */
+static const unsigned int QUANT_STRIDE = 4;
+
+/** Number of floats stored in the chunk table for each chunk (origin, 0, scale, 0) */
+static const unsigned int QUANT_CHUNK_STRIDE = 8;
+
+/** Default number of consecutive positions that share a chunk origin and scale */
+static const size_t QUANT_CHUNK_SIZE = 4096;
+
+// Function Declarations
+void quantizePositions(const float*, size_t, size_t, std::vector<unsigned short>&, std::vector<float>&);
+glm::vec3 dequantizePosition(const unsigned short*, const float*);
+
+}	// End of gui namespace
+}	// End of astrohelion namespace
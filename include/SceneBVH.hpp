@@ -0,0 +1,116 @@
+/**
+ *  @file SceneBVH.hpp
+ *	@brief Bounding volume hierarchy of line chunks for frustum culling
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+
+/*
+ *	Astrohelion
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Frustum.hpp"
+#include "Polyline.hpp"
+
+namespace astrohelion{
+namespace gui{
+
+/**
+ *	@brief A scene-wide bounding volume hierarchy (BVH) of line chunks
+ *	@details Each line added to the index is split into chunks of consecutive
+ *	segments, and each chunk is bounded by an axis-aligned box. The boxes of
+ *	every line in the scene are organized into one binary BVH so that a view
+ *	frustum can be tested against all of them in roughly logarithmic time.
+ *	cull() produces, for each line, the ranges of segments whose chunks may be
+ *	visible; these are passed to Polyline::setVisibleRanges() or
+ *	PolylineBatch::setVisibleRanges() so that only those ranges are drawn.
+ *	
+ *	The index stores bounds only; it does not reference the lines themselves,
+ *	so it must be rebuilt if a line is modified.
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+class SceneBVH{
+public:
+	SceneBVH();
+
+	int addLine(const float*, size_t, size_t stride = 3, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+	void build();
+	void clear();
+	void cull(const Frustum&);
+
+	size_t getNumChunks() const;
+	size_t getNumLines() const;
+	size_t getNumSegments() const;
+	size_t getNumVisibleChunks() const;
+	size_t getNumVisibleSegments() const;
+	const std::vector<SegmentRange>& getVisibleRanges(int) const;
+
+	static const size_t DEFAULT_CHUNK_SIZE;	//!< Default number of segments in each chunk
+protected:
+	/**
+	 *	@brief A range of consecutive segments of one line and its bounding box
+	 */
+	struct Chunk{
+		glm::vec3 lo {};			//!< Minimum corner of the bounding box, world coordinates
+		glm::vec3 hi {};			//!< Maximum corner of the bounding box, world coordinates
+		int line = 0;				//!< ID of the line, returned by addLine()
+		SegmentRange segments {};	//!< Segments of the line within the chunk
+	};
+
+	/**
+	 *	@brief A node of the hierarchy
+	 *	@details Every node covers a contiguous range of the chunk order array
+	 */
+	struct Node{
+		glm::vec3 lo {};			//!< Minimum corner of the bounding box of the node, world coordinates
+		glm::vec3 hi {};			//!< Maximum corner of the bounding box of the node, world coordinates
+		size_t first = 0;			//!< Index of the first chunk of the node in order
+		size_t count = 0;			//!< Number of chunks in the node
+		int left = -1;				//!< Index of the left child; -1 for a leaf
+		int right = -1;				//!< Index of the right child; -1 for a leaf
+	};
+
+	int buildNode(size_t, size_t);
+	void markVisible(size_t, size_t);
+
+	std::vector<Chunk> chunks {};		//!< Chunks, in the order they were added (grouped and sorted by line)
+	std::vector<size_t> order {};		//!< Chunk indices, ordered so that each node covers a contiguous range
+	std::vector<Node> nodes {};			//!< Nodes of the hierarchy; nodes[0] is the root
+	std::vector<char> visible {};		//!< Whether each chunk passed the most recent cull()
+	std::vector<std::vector<SegmentRange> > visibleRanges {};	//!< Visible segment ranges of each line
+	size_t numSegments = 0;				//!< Total number of segments in every line
+	size_t numVisibleChunks = 0;		//!< Number of chunks that passed the most recent cull()
+	size_t numVisibleSegments = 0;		//!< Number of segments that passed the most recent cull()
+	bool bBuilt = false;				//!< Whether the hierarchy describes the current chunks
+};
+
+}// End of gui namespace
+}// End of astrohelion namespace
@@ -0,0 +1,129 @@
+/**
+ *  @file SceneImporter.hpp
+ *	@brief Import many trajectories in parallel
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+ 
+/*
+ *	Astrohelion 
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *	
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TrajExtract.hpp"
+
+namespace astrohelion{
+namespace gui{
+
+// Forward Declarations
+class Polyline;
+class PolylineBatch;
+class TrajCache;
+
+/**
+ *	@brief Data and timing information for one imported trajectory
+ */
+struct SceneArc{
+	std::string filepath {};				//!< Path to the trajectory file
+	std::string error {};					//!< Error message; empty if the import succeeded
+
+	std::vector<float> vertices {};			//!< Vertex array built by Polyline::buildVertexData()
+	std::shared_ptr<TrajCache> pCache = nullptr;	//!< Mapped cache, used in place of the arrays if available
+	TrajMarkers markers {};					//!< Markers at the ends of the trajectory
+
+	double parseTime = 0;					//!< Time spent reading the file and building vertex data (worker thread), seconds
+	double uploadTime = 0;					//!< Time spent in uploadReady() on the arc (render thread), seconds; see SceneImporter::printReport()
+	bool bFromCache = false;				//!< Whether the data were loaded from a cache
+};
+
+/**
+ *	@brief Import a set of trajectory files concurrently
+ *	@details A pool of worker threads reads the files, extracts the node
+ *	positions, and builds the vertex data for each line; no OpenGL calls
+ *	are made off the render thread. The file reads themselves are serialized
+ *	(see getTrajReadMutex()), so the pool speeds up the work that follows them. The thread that owns the OpenGL context
+ *	calls uploadReady() (e.g., once per frame) to upload the finished lines
+ *	in the order the files were given.
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+class SceneImporter{
+public:
+	SceneImporter();
+	SceneImporter(const SceneImporter&) = delete;
+	~SceneImporter();
+
+	SceneImporter& operator =(const SceneImporter&) = delete;
+
+	void start(const std::vector<std::string>&, unsigned int numThreads = 0);
+	void stop();
+	size_t uploadReady(std::vector<Polyline>&, double maxSeconds = 0.005);
+	size_t uploadReady(PolylineBatch&, double maxSeconds = 0.005);
+
+	size_t getNumFiles() const;
+	size_t getNumParsed() const;
+	size_t getNumUploaded() const;
+	double getElapsedTime() const;
+	const std::vector<SceneArc>& getArcs() const;
+	bool isFinished() const;
+
+	void printReport() const;
+	void setUseCache(bool);
+
+	static std::vector<std::string> listDirectory(const char*, const char* ext = ".mat");
+
+protected:
+	void work();
+	void importArc(SceneArc&);
+	size_t uploadArcs(const std::function<void (SceneArc&)>&, double);
+
+	std::vector<std::thread> workers {};	//!< Worker thread pool
+	std::vector<SceneArc> arcs {};			//!< One entry per file; each is written by exactly one worker until it is marked ready
+
+	mutable std::mutex readyMutex;			//!< Guards bReady
+	std::vector<bool> bReady {};			//!< Whether each arc has been processed by a worker
+
+	std::atomic<size_t> nextFile;			//!< Index of the next file a worker should import
+	std::atomic<size_t> numParsed;			//!< Number of files processed by the workers
+	std::atomic<bool> bAbort;				//!< Flag to tell the workers to quit early
+	size_t numUploaded = 0;					//!< Number of arcs uploaded (render thread only)
+
+	bool bUseCache = true;					//!< Whether or not to read and write trajectory caches
+	bool bQueued = false;					//!< Whether the arcs were added to a PolylineBatch, which uploads them when it is drawn
+
+	std::chrono::steady_clock::time_point startTime {};	//!< Time the import started
+	double totalTime = 0;					//!< Time from start() to the final upload, seconds
+};
+
+}// End of gui namespace
+}// End of astrohelion namespace
@@ -24,6 +24,8 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "GL/glew.h"	// Include GLEW to get all the required OpenGL headers
 
@@ -35,8 +37,44 @@ namespace gui{
 // Forward Declarations
 
 
+/** Uniform block binding point of the "Camera" block declared by every shader */
+static const GLuint CAMERA_BLOCK_BINDING = 0;
+
+/**
+ *	@brief Contents of the "Camera" uniform block (std140 layout)
+ *	@details Each window stores one copy in a uniform buffer, uploads it once
+ *	per frame, and binds it to CAMERA_BLOCK_BINDING; shaders read the camera
+ *	from the block instead of from uniforms set on each program.
+ */
+struct CameraUniforms{
+	glm::mat4 view {};			//!< View matrix
+	glm::mat4 projection {};	//!< Projection matrix
+	glm::mat4 viewProj {};		//!< projection*view
+	glm::vec2 viewportSize {};	//!< Size of the viewport, pixels
+	GLfloat time = 0;			//!< Time since the app started, seconds
+	GLfloat pad = 0;			//!< Unused; pads the block to a multiple of 16 bytes
+};
+
+static_assert(sizeof(CameraUniforms) == 208, "CameraUniforms must match the std140 layout of the Camera block");
+
+/**
+ *	@brief An active uniform or attribute of a linked shader program
+ */
+struct ShaderVariable{
+	GLint location = -1;	//!< Location passed to glUniform*() or glVertexAttribPointer(); -1 for uniforms in a block
+	GLenum type = 0;		//!< Data type, e.g., GL_FLOAT_VEC3
+	GLint size = 0;			//!< Number of elements; greater than one for arrays
+};
+
 /**
  *	@brief A shader object
+ *	@details Every active uniform and attribute is queried once, when the
+ *	program is linked, and stored by name; the set functions look the
+ *	location up in that table rather than asking the driver. Resolve a
+ *	location with getUniformLocation() and pass it to the overloads that take
+ *	a location to skip the lookup as well. Setting a uniform that is not
+ *	active in the program (e.g., a misspelled name, or a uniform the compiler
+ *	removed because it is unused) prints a warning the first time.
  *
  *	@author Andrew Cox
  *	@version September 25, 2016
@@ -54,7 +92,12 @@ public:
 	Shader& use();
 
 	// Set and Get functions
+	GLint getAttribLocation(const GLchar*) const;
+	const std::unordered_map<std::string, ShaderVariable>& getAttributes() const;
 	GLuint getID() const;
+	GLint getUniformLocation(const GLchar*);
+	const std::unordered_map<std::string, ShaderVariable>& getUniforms() const;
+	bool hasUniform(const GLchar*) const;
     
     // Utility functions
     void setFloat    (const GLchar*, GLfloat, GLboolean useShader = false);
@@ -67,10 +110,28 @@ public:
     void setVector4f (const GLchar*, const glm::vec4&, GLboolean useShader = false);
     void setMatrix4  (const GLchar*, const glm::mat4&, GLboolean useShader = false);
 
+    void setFloat    (GLint, GLfloat, GLboolean useShader = false);
+    void setInteger  (GLint, GLint, GLboolean useShader = false);
+    void setVector2f (GLint, GLfloat, GLfloat, GLboolean useShader = false);
+    void setVector2f (GLint, const glm::vec2&, GLboolean useShader = false);
+    void setVector3f (GLint, GLfloat, GLfloat, GLfloat, GLboolean useShader = false);
+    void setVector3f (GLint, const glm::vec3&, GLboolean useShader = false);
+    void setVector4f (GLint, GLfloat, GLfloat, GLfloat, GLfloat, GLboolean useShader = false);
+    void setVector4f (GLint, const glm::vec4&, GLboolean useShader = false);
+    void setMatrix4  (GLint, const glm::mat4&, GLboolean useShader = false);
+
 protected:
 	GLuint id = 0;		//!< The program ID
+	std::unordered_map<std::string, ShaderVariable> uniforms {};	//!< Active uniforms, by name; arrays are also stored by their name without "[0]"
+	std::unordered_map<std::string, ShaderVariable> attributes {};	//!< Active vertex attributes, by name
+	std::unordered_set<std::string> warnedUniforms {};				//!< Inactive uniforms that have already been reported
+
 	void checkCompileErrors(GLuint, std::string);
+	void reflect();
 };
 
+// Function Declarations
+void bindCameraUniforms(const CameraUniforms&, GLuint*);
+
 }// End of gui namespace
 }// End of Astrohelion namespace
\ No newline at end of file
@@ -36,7 +36,7 @@ class Texture2D{
 public:
     Texture2D();
     
-    void generate(GLuint width, GLuint height, unsigned char* data);
+    void generate(GLuint width, GLuint height, const unsigned char* data);
     
     void bind() const;
 
@@ -0,0 +1,107 @@
+/**
+ *  @file TrajCache.hpp
+ *	@brief Binary, GPU-ready cache of trajectory vertex data
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+ 
+/*
+ *	Astrohelion 
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *	
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace astrohelion{
+namespace gui{
+
+/**
+ *	@brief Header at the beginning of every trajectory cache file
+ *	@details All offsets are measured in bytes from the beginning of
+ *	the file and are aligned to 16 bytes.
+ */
+struct TrajCacheHeader{
+	char magic[8];				//!< File identifier, TrajCache::MAGIC
+	uint32_t version;			//!< File format version, TrajCache::VERSION
+	uint32_t vertexStride;		//!< Number of floats per vertex
+	uint64_t srcSize;			//!< Size of the source trajectory file, bytes
+	int64_t srcModTime;			//!< Modification time of the source trajectory file, seconds since epoch
+	uint64_t numPoints;			//!< Number of trajectory points (nodes)
+	uint64_t numVertices;		//!< Number of vertices (points plus adjacency vertices)
+	uint64_t vertexOffset;		//!< Offset to vertex data (vertexStride floats per vertex)
+	uint64_t epochOffset;		//!< Offset to node epochs (one double per point), or zero if no epochs are stored
+};
+
+/**
+ *	@brief A memory-mapped cache of the vertex data derived from a trajectory file
+ *	@details The cache stores exactly the vertex array that Polyline uploads to the
+ *	GPU so that, once mapped, the data can be handed to glBufferData() directly.
+ *	The trajectory points are stored contiguously within the vertex array, optionally
+ *	followed by the epoch of each point.
+ *	A cache is considered stale if the size or modification time of the source
+ *	trajectory file has changed since the cache was written.
+ *	
+ *	Memory mapping is implemented with POSIX functions; on other platforms open()
+ *	always fails and the caller falls back to parsing the trajectory file.
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+class TrajCache{
+public:
+	TrajCache();
+	TrajCache(const TrajCache&) = delete;
+	~TrajCache();
+
+	TrajCache& operator =(const TrajCache&) = delete;
+
+	bool open(const char*, const char*);
+	void close();
+	static void write(const char*, const char*, const std::vector<float>&,
+		const std::vector<double> &epochs = std::vector<double>());
+	static void writeVertices(const char*, const char*, const std::vector<float>&,
+		const std::vector<double> &epochs = std::vector<double>());
+
+	static std::string getCachePath(const char*);
+
+	size_t getNumPoints() const;
+	size_t getNumVertices() const;
+	unsigned int getVertexStride() const;
+
+	const double* getEpochs() const;
+	const float* getPoints() const;
+	const float* getVertices() const;
+
+	static const char MAGIC[8];		//!< Identifies a trajectory cache file
+	static const uint32_t VERSION;	//!< Current file format version
+protected:
+	void* pData = nullptr;			//!< Pointer to the mapped file
+	size_t dataSize = 0;			//!< Size of the mapped file, bytes
+	TrajCacheHeader header {};		//!< Copy of the file header
+};
+
+}// End of gui namespace
+}// End of astrohelion namespace
@@ -0,0 +1,66 @@
+/**
+ *  @file TrajExtract.hpp
+ *	@brief Bulk conversion of trajectory states to render-ready arrays
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+ 
+/*
+ *	Astrohelion 
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *	
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace astrohelion{
+
+// Forward Declarations
+class Traj_bc4bp;
+
+namespace gui{
+
+/**
+ *	@brief Marker data (e.g., for a BillboardSet) produced while extracting
+ *	trajectory positions
+ */
+struct TrajMarkers{
+	std::vector<float> points {};		//!< Marker positions (x, y, z for each marker)
+	std::vector<float> colors {};		//!< Marker colors (RGBA for each marker)
+
+	unsigned int nodeStride = 0;		//!< If nonzero, a marker is also placed at every nodeStride-th node
+	float startColor[4] = {0.f, 1.f, 0.f, 1.f};	//!< Color of the marker at the first node
+	float endColor[4] = {1.f, 0.f, 0.f, 1.f};	//!< Color of the marker at the final node
+	float nodeColor[4] = {0.9f, 0.9f, 0.9f, 1.f};	//!< Color of the intermediate node markers
+};
+
+// Function Declarations
+void narrowPositions(const double* const*, size_t, float*);
+void extractPositions(const Traj_bc4bp&, int, int, float*, TrajMarkers *pMarkers = nullptr, unsigned int numThreads = 1);
+void extractPositions(const Traj_bc4bp&, std::vector<float>&, TrajMarkers *pMarkers = nullptr, unsigned int numThreads = 0);
+void appendMarkers(const float*, int, int, int, TrajMarkers*);
+void extractEpochs(const Traj_bc4bp&, std::vector<double>&);
+std::mutex& getTrajReadMutex();
+
+}	// END of gui namespace
+}	// END of astrohelion namespace
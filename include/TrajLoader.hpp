@@ -0,0 +1,116 @@
+/**
+ *  @file TrajLoader.hpp
+ *	@brief Load trajectory data on a background thread
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+ 
+/*
+ *	Astrohelion 
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *	
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Polyline.hpp"
+#include "TrajExtract.hpp"
+
+namespace astrohelion{
+namespace gui{
+
+// Forward Declarations
+class TrajCache;
+
+/**
+ *	@brief Parse a trajectory file on a worker thread and deliver the
+ *	node positions in chunks
+ *	@details The worker thread never touches OpenGL; the thread that owns
+ *	the context polls popChunk() (e.g., once per frame) and uploads each
+ *	chunk, so the window remains responsive while large files load.
+ *	
+ *	If a valid TrajCache exists for the file, the cache is mapped instead
+ *	of parsing the file and is delivered via takeCache(); otherwise, a cache
+ *	is written once the file has been parsed. The simplified levels of detail
+ *	of the line are computed on the worker as well (see Polyline::computeLOD())
+ *	and delivered via takeLOD(), so only their upload happens on the thread
+ *	that owns the context.
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+class TrajLoader{
+public:
+	TrajLoader();
+	TrajLoader(const TrajLoader&) = delete;
+	~TrajLoader();
+
+	TrajLoader& operator =(const TrajLoader&) = delete;
+
+	void start(const char*, unsigned int chunkSize = 20000);
+	void stop();
+
+	bool popChunk(std::vector<float>&);
+	std::shared_ptr<TrajCache> takeCache();
+	bool takeLOD(std::vector<LineLOD>&, std::vector<unsigned int>&);
+
+	std::vector<double> getEpochs() const;
+	std::string getError() const;
+	TrajMarkers getMarkers() const;
+	int getNumLoaded() const;
+	int getNumNodes() const;
+	bool isDone() const;
+	bool isFinished() const;
+
+	void setUseCache(bool);
+
+protected:
+	void run(std::string, unsigned int);
+	void pushChunk(std::vector<float>&);
+
+	std::thread worker;						//!< Thread that parses the file
+
+	mutable std::mutex dataMutex;			//!< Guards chunks, markers, epochs, lodLevels, lodIx, errMsg, and pCache
+	std::deque<std::vector<float> > chunks {};	//!< Chunks of node positions waiting to be uploaded
+	TrajMarkers markers {};					//!< Markers at the first and last nodes
+	std::vector<double> epochs {};			//!< Epoch of each node; filled once the file is parsed
+	std::vector<LineLOD> lodLevels {};		//!< Simplified levels of detail of the line; filled once every node is extracted
+	std::vector<unsigned int> lodIx {};		//!< Index array of the levels in lodLevels
+	std::string errMsg {};					//!< Error message from the worker thread, if any
+	std::shared_ptr<TrajCache> pCache = nullptr;	//!< Mapped cache waiting to be retrieved, if any
+
+	bool bUseCache = true;					//!< Whether or not to read and write trajectory caches
+
+	std::atomic<int> numNodes;				//!< Total number of nodes in the trajectory; -1 until the file is parsed
+	std::atomic<int> numLoaded;				//!< Number of nodes extracted so far
+	std::atomic<bool> bDone;				//!< Whether the worker thread has finished
+	std::atomic<bool> bAbort;				//!< Flag to tell the worker thread to quit early
+};
+
+}// End of gui namespace
+}// End of astrohelion namespace
@@ -111,7 +111,10 @@ protected:
 	unsigned int imgui_VAO = 0;		//!< Vertex Array Object for ImGui stuff
 	unsigned int imgui_EBO = 0;		//!< Element Buffer Object for ImGui stuff
 
+	unsigned int cameraUBO = 0;		//!< Uniform buffer that stores the CameraUniforms of this window
+
 	void preDraw();
+	void uploadCameraUniforms();
 	virtual void draw();
 	void postDraw();
 
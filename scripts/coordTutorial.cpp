@@ -180,6 +180,10 @@ int main(){
         SOIL_free_image_data(image2);
     glBindTexture(GL_TEXTURE_2D, 0);
 
+    astroGui::CameraUniforms cam;
+    cam.viewportSize = glm::vec2(width, height);
+    GLuint cameraUBO = 0;
+
     // Do drawing!
     glClear(GL_COLOR_BUFFER_BIT);	// Clear buffer from any previous usage
     glfwSetKeyCallback(window, keyCallback);
@@ -200,10 +204,13 @@ int main(){
     	ourShader.use();
     	
         GLuint modelLoc = glGetUniformLocation(ourShader.getID(), "model");
-        GLuint viewLoc = glGetUniformLocation(ourShader.getID(), "view");
-        GLuint projLoc = glGetUniformLocation(ourShader.getID(), "projection");
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+
+        // The view and projection are read from the Camera uniform block
+        cam.view = view;
+        cam.projection = projection;
+        cam.viewProj = projection*view;
+        cam.time = currentFrame;
+        astroGui::bindCameraUniforms(cam, &cameraUBO);
 
         // 5. Draw the object
         glActiveTexture(GL_TEXTURE0);
@@ -232,6 +239,7 @@ int main(){
     	glfwSwapBuffers(window);	// swap the front and back buffers for smooth rendering
     }
 
+    glDeleteBuffers(1, &cameraUBO);
     glfwTerminate();		// Clean up and delete all resources that were allocated
 
 	return EXIT_SUCCESS;
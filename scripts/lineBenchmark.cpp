@@ -0,0 +1,165 @@
+/**
+ *  @brief Compare the geometry shader and vertex pulling thick line paths
+ *  @details Draws the same line with each Polyline render mode and reports
+ *  the average GPU time (GL_TIME_ELAPSED queries) and wall time per frame.
+ *  
+ *  Usage: lineBenchmark [numPoints] [numFrames]
+ */
+
+#include <GL/glew.h>		// This header must be included BEFORE glfw
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "App.hpp"
+#include "GLErrorHandling.hpp"
+#include "Polyline.hpp"
+#include "ResourceManager.hpp"
+#include "Shader.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace astroGui = astrohelion::gui;
+
+struct BenchResult{
+    double gpuTime = 0;     // Average GPU time per frame, ms
+    double wallTime = 0;    // Average wall time per frame, ms
+};
+
+BenchResult runBenchmark(GLFWwindow*, astroGui::Polyline&, astroGui::LineRender_tp, int);
+
+int main(int argc, char** argv){
+    int numPoints = argc > 1 ? atoi(argv[1]) : 1000000;
+    int numFrames = argc > 2 ? atoi(argv[2]) : 200;
+    if(numPoints < 2 || numFrames < 1){
+        std::cout << "Usage: lineBenchmark [numPoints >= 2] [numFrames >= 1]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    astroGui::App app;  // Create an App to store global resource manager
+    app.init();         // initialize GLFW and GLEW 
+
+    GLFWwindow* window = glfwCreateWindow(1280, 720, "Line Benchmark", nullptr, nullptr);
+    if(window == nullptr){
+    	std::cout << "Failed to create GLFW window" << std::endl;
+    	glfwTerminate();
+    	return EXIT_FAILURE;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);    // Do not wait for vsync
+
+    glewExperimental = GL_TRUE;
+    if(glewInit() != GLEW_OK){
+    	std::cout << "Failed to initialize GLEW" << std::endl;
+    	return EXIT_FAILURE;
+    }
+
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    glViewport(0,0,width,height);
+
+    std::shared_ptr<astroGui::ResourceManager> resourceManager = app.getResMan();
+    resourceManager->loadShader("../shaders/line_thick.vs",
+        "../shaders/line_thick.frag", "../shaders/line_thick.geom", "line_thick");
+    resourceManager->loadShader("../shaders/line_thick_pull.vs",
+        "../shaders/line_thick.frag", nullptr, "line_thick_pull");
+
+    // A tightly wound spiral with sharp corners every few points exercises both the miter and bevel code
+    std::vector<float> points(3*numPoints, 0);
+    for(int i = 0; i < numPoints; i++){
+        double t = 40*M_PI*i/numPoints;
+        double r = 0.2 + 0.6*i/numPoints + (i % 7 == 0 ? 0.02 : 0);
+        points[3*i+0] = static_cast<float>(r*cos(t));
+        points[3*i+1] = static_cast<float>(r*sin(t));
+        points[3*i+2] = 0;
+    }
+
+    astroGui::Polyline line(points);
+    line.setThickness(2);
+
+    // Both line shaders read the camera from the Camera uniform block; the
+    // identity view and projection draw the spiral in normalized coordinates
+    astroGui::CameraUniforms cam;
+    cam.viewportSize = glm::vec2(width, height);
+    GLuint cameraUBO = 0;
+    astroGui::bindCameraUniforms(cam, &cameraUBO);
+
+    astroGui::checkForGLErrors("Post-Initialization");
+
+    printf("Drawing %d points, %d frames per mode, %dx%d framebuffer\n", numPoints, numFrames, width, height);
+    printf("  %-16s  %12s  %12s\n", "Mode", "GPU (ms)", "Wall (ms)");
+
+    BenchResult gs = runBenchmark(window, line, astroGui::LineRender_tp::GEOMETRY_SHADER, numFrames);
+    printf("  %-16s  %12.3f  %12.3f\n", "Geometry shader", gs.gpuTime, gs.wallTime);
+
+    BenchResult pull = runBenchmark(window, line, astroGui::LineRender_tp::VERTEX_PULL, numFrames);
+    printf("  %-16s  %12.3f  %12.3f\n", "Vertex pulling", pull.gpuTime, pull.wallTime);
+
+    if(pull.gpuTime > 0)
+        printf("  GPU speedup from vertex pulling: %.2fx\n", gs.gpuTime/pull.gpuTime);
+
+    astroGui::checkForGLErrors("Post-Benchmark");
+
+    line.destroy();
+    glDeleteBuffers(1, &cameraUBO);
+    glfwTerminate();
+
+	return EXIT_SUCCESS;
+}//====================================================
+
+/**
+ *  @brief Time the draw of a line with one render mode
+ * 
+ *  @param window window to draw in
+ *  @param line line to draw
+ *  @param mode render mode
+ *  @param numFrames number of timed frames; a few untimed frames are drawn first
+ *  @return the average GPU and wall time per frame
+ */
+BenchResult runBenchmark(GLFWwindow *window, astroGui::Polyline &line, astroGui::LineRender_tp mode, int numFrames){
+    typedef std::chrono::steady_clock Clock;
+
+    line.setRenderMode(mode);
+
+    // Warm up: compile shader variants, page in buffers
+    for(int f = 0; f < 5; f++){
+        glClear(GL_COLOR_BUFFER_BIT);
+        line.draw();
+        glfwSwapBuffers(window);
+    }
+    glFinish();
+
+    GLuint query;
+    glGenQueries(1, &query);
+
+    BenchResult result;
+    Clock::time_point t0 = Clock::now();
+    for(int f = 0; f < numFrames; f++){
+        glfwPollEvents();
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        line.draw();
+        glEndQuery(GL_TIME_ELAPSED);
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);    // Blocks until the draw completes
+        result.gpuTime += ns*1e-6;
+
+        glfwSwapBuffers(window);
+    }
+    glFinish();
+    result.wallTime = std::chrono::duration<double, std::milli>(Clock::now() - t0).count()/numFrames;
+    result.gpuTime /= numFrames;
+
+    glDeleteQueries(1, &query);
+    return result;
+}//====================================================
@@ -22,6 +22,7 @@
 #include "GLErrorHandling.hpp"
 #include "Polyline.hpp"
 #include "ResourceManager.hpp"
+#include "Shader.hpp"
 
 #include <cmath>
 #include <iostream>
@@ -60,7 +61,7 @@ int main(){
 
     // std::shared_ptr<astroGui::ResourceManager> resourceManager(new astroGui::ResourceManager());
     std::shared_ptr<astroGui::ResourceManager> resourceManager = app.getResMan();
-    astroGui::Shader lineShader = resourceManager->loadShader("../shaders/line_thick.vs",
+    resourceManager->loadShader("../shaders/line_thick.vs",
         "../shaders/line_thick.frag", "../shaders/line_thick.geom", "line_thick");
 
     std::vector<float> points = {
@@ -75,9 +76,10 @@ int main(){
 
     astroGui::checkForGLErrors("Post VBO, EBO, VAO Initialization");
 
-    // Create dummy model-view-projection matrix
-    glm::mat4 modelViewProj;
-    lineShader.setVector2f("viewportSize", width, height, true);
+    // The line shader reads the camera from the Camera uniform block
+    astroGui::CameraUniforms cam;
+    cam.viewportSize = glm::vec2(width, height);
+    GLuint cameraUBO = 0;
 
     glClear(GL_COLOR_BUFFER_BIT);   // Clear buffer from any previous usage
     glfwSetKeyCallback(window, keyCallback);
@@ -92,8 +94,9 @@ int main(){
 
         // Activate the shader
         angle = glm::radians(1.0f);
-        modelViewProj = glm::rotate(modelViewProj, angle, glm::vec3(0.0f, 0.1f, 0.0f));
-        lineShader.setMatrix4("modelViewProjectionMatrix", modelViewProj, true);
+        cam.viewProj = glm::rotate(cam.viewProj, angle, glm::vec3(0.0f, 0.1f, 0.0f));
+        cam.time = glfwGetTime();
+        astroGui::bindCameraUniforms(cam, &cameraUBO);
         
         line.draw();
 
@@ -102,6 +105,7 @@ int main(){
         glfwSwapBuffers(window);    // swap the front and back buffers for smooth rendering
     }
 
+    glDeleteBuffers(1, &cameraUBO);
     glfwTerminate();		// Clean up and delete all resources that were allocated
 
 	return EXIT_SUCCESS;
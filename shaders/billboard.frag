@@ -1,13 +1,48 @@
 #version 330 core
+/**
+ *  \brief Cut a circle or hexagon out of each billboard quad
+ *  \details The shape is described by a signed distance function of the
+ *  position within the quad; the distance is converted to coverage over the
+ *  width of one fragment so that the edges are antialiased.
+ */
 
-// Vertex data from the geometry shader
+// Vertex data from the vertex shader
 in VertexData{
     vec4 mColor;
+    vec2 mCorner;
+    float mRadius;
 } VertexIn;
 
+uniform int shape;	//!< 0 = circle, 1 = hexagon (see BillboardShape_tp)
+
 out vec4 color;
 
+/**
+ *  \brief Signed distance to a regular hexagon with vertices on the x-axis
+ * 
+ *  \param p position relative to the center of the hexagon
+ *  \param r distance from the center to each vertex
+ *  \return distance to the edge; negative inside the hexagon
+ */
+float sdHexagon(vec2 p, float r){
+	const vec3 k = vec3(-0.866025404, 0.5, 0.577350269);
+	float h = -k.x*r;		// Distance from the center to each edge
+	p = abs(p);
+	p -= 2.0*min(dot(k.xy, p), 0.0)*k.xy;
+	p -= vec2(clamp(p.x, -k.z*h, k.z*h), h);
+	return length(p)*sign(p.y);
+}
+
 void main(void){
+	float d = shape == 1 ? sdHexagon(VertexIn.mCorner, VertexIn.mRadius) :
+		length(VertexIn.mCorner) - VertexIn.mRadius;
+
+	// Fraction of the fragment covered by the shape
+	float w = max(fwidth(d), 1e-4);
+	float coverage = clamp(0.5 - d/w, 0.0, 1.0);
+	if(coverage <= 0.0)
+		discard;
+
 	// Apply color data passed in from the program/vertex shader
-    color = VertexIn.mColor;
-}
\ No newline at end of file
+    color = vec4(VertexIn.mColor.rgb, VertexIn.mColor.a*coverage);
+}
@@ -1,26 +1,88 @@
 #version 330 core
+/**
+ *  \brief Expand each billboard instance into a screen-aligned quad
+ *  \details Four vertices are drawn per instance as a triangle strip; the corner
+ *  of each vertex is derived from gl_VertexID, so no vertex buffer is needed for
+ *  the quad. The quad is one pixel larger than the billboard so that
+ *  billboard.frag has room to antialias the edge of the shape.
+ *  
+ *  If bLineNodes, the positions are read from the vertex buffer of a Polyline
+ *  (one adjacency vertex, then one vertex per node) instead of the Vertex and
+ *  ChunkID attributes.
+ */
 
-layout (location = 0) in vec3 Vertex; 	//!< Position of the billboard, world coordinates
+layout (location = 0) in vec3 Vertex; 	//!< Position of the billboard, world coordinates, or offset within the chunk if bQuantized
 layout (location = 1) in vec4 Color;	//!< Color of the billboard
-  
-uniform mat4 viewProj;				//!< The View-Projection matrix
-uniform vec2 viewportSize;			//!< Size of the viewport, pixels
+layout (location = 2) in uint ChunkID;	//!< Index of the chunk that contains the billboard; only read if bQuantized
+layout (location = 3) in float Radius;	//!< Radius of the billboard, pixels
+layout (location = 4) in uint NodeIndex;	//!< Index of the marked line node; only read if bLineNodes and bLineIndexed
+
+// Camera of the window being drawn (CameraUniforms, binding CAMERA_BLOCK_BINDING)
+layout (std140) uniform Camera{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;          // projection*view
+    vec2 viewportSize;      // Size of the viewport, pixels
+    float time;             // Time since the app started, seconds
+} camera;
+
 uniform vec2 offset;				//!< Offset from Vertex in pixels
+uniform bool bQuantized;			//!< Whether Vertex stores normalized offsets within a chunk
+uniform samplerBuffer chunkTable;	//!< Two texels per chunk: origin, scale (world coordinates)
+
+uniform bool bLineNodes;			//!< Whether the billboards mark the nodes of a line
+uniform samplerBuffer lineVertices;	//!< Line vertex buffer; three R32F texels per vertex, or one RGBA16 texel if bQuantized
+uniform bool bLineIndexed;			//!< Whether the marked node is NodeIndex rather than nodeFirst + nodeStride*gl_InstanceID
+uniform int nodeFirst;				//!< Index of the first marked node
+uniform int nodeStride;				//!< Number of nodes between consecutive markers
 
 out VertexData{
-    vec4 mColor;
+    vec4 mColor;		//!< Color of the billboard
+    vec2 mCorner;		//!< Position of the vertex relative to the center of the billboard, pixels
+    float mRadius;		//!< Radius of the billboard, pixels
 } VertexOut;
 
 void main(){
 
+	vec3 pos = Vertex;
+	uint chunk = ChunkID;
+	if(bLineNodes){
+		int v = 1 + (bLineIndexed ? int(NodeIndex) : nodeFirst + nodeStride*gl_InstanceID);	// Skip the adjacency vertex
+		if(bQuantized){
+			vec4 q = texelFetch(lineVertices, v);
+			pos = q.xyz;
+			chunk = uint(q.w*65535.0 + 0.5);
+		}else{
+			pos = vec3(texelFetch(lineVertices, 3*v).r, texelFetch(lineVertices, 3*v + 1).r,
+				texelFetch(lineVertices, 3*v + 2).r);
+		}
+	}
+
+	if(bQuantized){
+		int c = 2*int(chunk);
+		pos = texelFetch(chunkTable, c).xyz + texelFetch(chunkTable, c + 1).xyz*pos;
+	}
+
 	// Transform world coordinates to screen coordinates (we don't apply a model matrix)
-	gl_Position = viewProj * vec4(Vertex, 1.0);
+	gl_Position = camera.viewProj * vec4(pos, 1.0);
+
+	// Billboards behind the camera are moved outside the clip volume
+	if(gl_Position.w <= 0){
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
 
 	// Divide by w so that scale of object remains constant
 	gl_Position /= gl_Position.w;
 
-	// Translate vertex according to offset
-	gl_Position.xy += offset/viewportSize;	// divide by viewportSize to convert pixels to normalized coordinates
+	// Corners (-1, -1), (1, -1), (-1, 1), (1, 1) in triangle strip order
+	vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1))*2.0 - 1.0;
+	corner *= Radius + 1.0;
+
+	// Translate vertex according to offset and corner
+	gl_Position.xy += (offset + corner)/camera.viewportSize;	// divide by viewportSize to convert pixels to normalized coordinates
 
     VertexOut.mColor = Color; // Set mColor to the input color we got from the vertex data
-}
\ No newline at end of file
+    VertexOut.mCorner = corner;
+    VertexOut.mRadius = Radius;
+}
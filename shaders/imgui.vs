@@ -1,4 +1,13 @@
 #version 330
+// Camera of the window being drawn (CameraUniforms, binding CAMERA_BLOCK_BINDING)
+layout (std140) uniform Camera{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;          // projection*view
+    vec2 viewportSize;      // Size of the viewport, pixels
+    float time;             // Time since the app started, seconds
+} camera;
+
 uniform mat4 ProjMtx;
 in vec2 Position;
 in vec2 UV;
@@ -0,0 +1,27 @@
+#version 330 core
+
+// Camera of the window being drawn (CameraUniforms, binding CAMERA_BLOCK_BINDING)
+layout (std140) uniform Camera{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;          // projection*view
+    vec2 viewportSize;      // Size of the viewport, pixels
+    float time;             // Time since the app started, seconds
+} camera;
+
+uniform samplerBuffer lineStyles;       // Two RGBA texels per line: color, then (thickness, 0, 0, 0)
+
+layout(location = 0) in vec3 Vertex;	// Line points; world coordinates
+layout(location = 1) in int LineID;     // Index of the line the point belongs to
+
+// Output vertex data to the geometry shader
+out VertexData{
+    vec4 mColor;
+    float mThickness;
+} VertexOut;
+
+void main(void){
+    VertexOut.mColor = texelFetch(lineStyles, 2*LineID);
+    VertexOut.mThickness = texelFetch(lineStyles, 2*LineID + 1).x;
+    gl_Position = camera.viewProj * vec4(Vertex, 1);
+}
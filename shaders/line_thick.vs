@@ -1,16 +1,48 @@
 #version 330 core
 
-uniform mat4 modelViewProjectionMatrix;
+// Camera of the window being drawn (CameraUniforms, binding CAMERA_BLOCK_BINDING)
+layout (std140) uniform Camera{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;          // projection*view
+    vec2 viewportSize;      // Size of the viewport, pixels
+    float time;             // Time since the app started, seconds
+} camera;
 
-layout(location = 0) in vec3 Vertex;	// Line points; world coordinates
-layout(location = 1) in vec4 Color;		// Color of the point
+uniform float thickness;                // Line thickness, pixels
+
+uniform vec4 lineColor;                 // Color of the line (RGBA)
+
+uniform bool bQuantized;                // Whether Vertex stores normalized offsets within a chunk
+uniform samplerBuffer chunkTable;       // Two texels per chunk: origin, scale (world coordinates)
+
+uniform bool bFade;                     // Whether to fade the line out by age
+uniform float fadeEnd;                  // Epoch at which the age is zero, relative to the first point
+uniform float fadeAge;                  // Age at which the line is fully transparent
+
+layout(location = 0) in vec3 Vertex;	// Line points; world coordinates, or offsets within the chunk if bQuantized
+layout(location = 1) in float Epoch;	// Epoch of the point relative to the first point; only read if bFade
+layout(location = 2) in uint ChunkID;	// Index of the chunk that contains the point; only read if bQuantized
 
 // Output vertex data to the geometry shader
 out VertexData{
     vec4 mColor;
+    float mThickness;
 } VertexOut;
 
 void main(void){
-    VertexOut.mColor = Color;
-    gl_Position = modelViewProjectionMatrix * vec4(Vertex, 1);
-}
\ No newline at end of file
+    vec3 pos = Vertex;
+    if(bQuantized){
+        int c = 2*int(ChunkID);
+        pos = texelFetch(chunkTable, c).xyz + texelFetch(chunkTable, c + 1).xyz*Vertex;
+    }
+
+    // The fade is linear in age, so interpolating it across each segment
+    // gives every fragment the alpha of its own age
+    VertexOut.mColor = lineColor;
+    if(bFade)
+        VertexOut.mColor.a *= 1.0 - clamp(abs(fadeEnd - Epoch)/fadeAge, 0.0, 1.0);
+
+    VertexOut.mThickness = thickness;
+    gl_Position = camera.viewProj * vec4(pos, 1);
+}
@@ -0,0 +1,166 @@
+#version 330 core
+
+/*
+ *  Thick line expansion without a geometry shader
+ *
+ *  Produces the same triangles as line_thick.geom. Each segment of the line
+ *  is drawn as nine vertices (three triangles) of a GL_TRIANGLES draw with no
+ *  vertex attributes; the vertex data are fetched ("pulled") from the line's
+ *  vertex buffer, which is bound as a buffer texture:
+ *
+ *  - Vertices 0-2: the bevel that closes the gap at a sharp corner; degenerate
+ *    (zero area) if the corner does not require one
+ *  - Vertices 3-8: the two triangles of the segment quad
+ *
+ *  Segment s uses line vertices s through s+3, i.e., the same four vertices
+ *  the GL_LINES_ADJACENCY path reads through the index buffer. When a level of
+ *  detail is drawn (bIndexed), the four vertices are read from its index array.
+ */
+
+// Camera of the window being drawn (CameraUniforms, binding CAMERA_BLOCK_BINDING)
+layout (std140) uniform Camera{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;          // projection*view
+    vec2 viewportSize;      // Size of the viewport, pixels
+    float time;             // Time since the app started, seconds
+} camera;
+
+uniform float thickness;
+uniform float miterLimit;
+
+uniform vec4 lineColor;             // Color of the line (RGBA)
+
+uniform samplerBuffer vertexData;   // Line vertex buffer, one float per texel
+uniform int vertexStride;           // Number of floats per vertex (position)
+uniform usamplerBuffer indexData;   // LOD index buffer, four indices per segment
+uniform bool bIndexed;              // Whether the segment vertices are read from indexData
+uniform int indexOffset;            // Offset of the first index of the level in indexData
+
+uniform samplerBuffer epochData;    // Epoch of each line vertex relative to the first point
+uniform bool bFade;                 // Whether to fade the line out by age
+uniform float fadeEnd;              // Epoch at which the age is zero, relative to the first point
+uniform float fadeAge;              // Age at which the line is fully transparent
+
+out VertexData{
+    vec2 mTexCoord;
+    vec4 mColor;
+} VertexOut;
+
+int lineVertex(int seg, int k){
+    return bIndexed ? int(texelFetch(indexData, indexOffset + 4*seg + k).r) : seg + k;
+}
+
+vec4 fetchPosition(int v){
+    int base = v*vertexStride;
+    vec3 pos = vec3(texelFetch(vertexData, base).r, texelFetch(vertexData, base + 1).r,
+        texelFetch(vertexData, base + 2).r);
+    return camera.viewProj * vec4(pos, 1);
+}
+
+/**
+ *  \brief Color of a line vertex, faded by age if requested; see line_thick.vs
+ */
+vec4 vertexColor(int v){
+    vec4 color = lineColor;
+    if(bFade)
+        color.a *= 1.0 - clamp(abs(fadeEnd - texelFetch(epochData, v).r)/fadeAge, 0.0, 1.0);
+    return color;
+}
+
+/**
+ *  \brief Convert from normalized screen coordinates to
+ *  flat, pixel screen coordinates; see line_thick.geom
+ */
+vec2 toScreenSpace(vec4 vertex){
+    return vec2( vertex.xy / vertex.w ) * camera.viewportSize;
+}
+
+void emit(vec2 p, vec2 texCoord, vec4 color){
+    VertexOut.mTexCoord = texCoord;
+    VertexOut.mColor = color;
+    gl_Position = vec4( p / camera.viewportSize, 0.0, 1.0 );
+}
+
+void main(void){
+    int seg = gl_VertexID / 9;
+    int corner = gl_VertexID - 9*seg;
+
+    vec2 p0 = toScreenSpace( fetchPosition(lineVertex(seg, 0)) );  // start of previous segment
+    vec2 p1 = toScreenSpace( fetchPosition(lineVertex(seg, 1)) );  // end of previous segment, start of current segment
+    vec2 p2 = toScreenSpace( fetchPosition(lineVertex(seg, 2)) );  // end of current segment, start of next segment
+    vec2 p3 = toScreenSpace( fetchPosition(lineVertex(seg, 3)) );  // end of next segment
+
+    // Every vertex of a discarded triangle is placed at the same point so it has no area
+    VertexOut.mTexCoord = vec2(0, 0);
+    VertexOut.mColor = vec4(0);
+    gl_Position = vec4(0, 0, 0, 1);
+
+    // perform naive culling
+    vec2 area = camera.viewportSize * 1.8;
+    if( p1.x < -area.x || p1.x > area.x ) return;
+    if( p1.y < -area.y || p1.y > area.y ) return;
+    if( p2.x < -area.x || p2.x > area.x ) return;
+    if( p2.y < -area.y || p2.y > area.y ) return;
+
+    // determine the direction of each of the 3 segments (previous, current, next)
+    vec2 v0 = normalize( p1 - p0 );
+    vec2 v1 = normalize( p2 - p1 );
+    vec2 v2 = normalize( p3 - p2 );
+
+    // determine the normal of each of the 3 segments (previous, current, next)
+    vec2 n0 = vec2( -v0.y, v0.x );
+    vec2 n1 = vec2( -v1.y, v1.x );
+    vec2 n2 = vec2( -v2.y, v2.x );
+
+    // determine miter lines by averaging the normals of the 2 segments
+    vec2 miter_a = normalize( n0 + n1 );	// miter at start of current segment
+    vec2 miter_b = normalize( n1 + n2 );    // miter at end of current segment
+
+    // determine the length of the miter by projecting it onto normal and then inverse it
+    float an1 = dot(miter_a, n1);
+    float bn1 = dot(miter_b, n2);
+    if (an1==0) an1 = 1;
+    if (bn1==0) bn1 = 1;
+    float length_a = thickness / an1;
+    float length_b = thickness / bn1;
+
+    // prevent excessively long miters at sharp corners
+    bool bBevel = dot( v0, v1 ) < -miterLimit;
+    if( bBevel ) {
+        miter_a = n1;
+        length_a = thickness;
+    }
+    if( dot( v1, v2 ) < -miterLimit ) {
+        miter_b = n1;
+        length_b = thickness;
+    }
+
+    vec4 color_a = vertexColor(lineVertex(seg, 1));    // color at the start of the current segment
+    vec4 color_b = vertexColor(lineVertex(seg, 2));    // color at the end of the current segment
+
+    if( corner < 3 ) {
+        // close the gap
+        if( !bBevel ) return;
+
+        if( dot( v0, n1 ) > 0 ) {
+            if( corner == 0 ) emit( p1 + thickness * n0, vec2( 0, 0 ), color_a );
+            else if( corner == 1 ) emit( p1 + thickness * n1, vec2( 0, 0 ), color_a );
+            else emit( p1, vec2( 0, 0.5 ), color_a );
+        }
+        else {
+            if( corner == 0 ) emit( p1 - thickness * n1, vec2( 0, 1 ), color_a );
+            else if( corner == 1 ) emit( p1 - thickness * n0, vec2( 0, 1 ), color_a );
+            else emit( p1, vec2( 0, 0.5 ), color_a );
+        }
+        return;
+    }
+
+    // Triangles (a, b, c) and (c, b, d) match the strip (a, b, c, d) emitted by the geometry shader
+    int q = corner - 3;
+    int stripVert = q < 3 ? q : (q == 3 ? 2 : (q == 4 ? 1 : 3));
+    if( stripVert == 0 ) emit( p1 + length_a * miter_a, vec2( 0, 0 ), color_a );
+    else if( stripVert == 1 ) emit( p1 - length_a * miter_a, vec2( 0, 1 ), color_a );
+    else if( stripVert == 2 ) emit( p2 + length_b * miter_b, vec2( 0, 0 ), color_b );
+    else emit( p2 - length_b * miter_b, vec2( 0, 1 ), color_b );
+}
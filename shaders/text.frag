@@ -1,12 +1,15 @@
 #version 330 core
 in vec2 TexCoords;
+in vec3 TextColor;
 out vec4 color;
 
-uniform sampler2D text;
-uniform vec3 textColor;
+uniform sampler2D text;     // Glyph atlas; signed distance fields with the outline at 0.5
 
 void main()
 {    
-    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
-    color = vec4(textColor, 1.0) * sampled;
-} 
\ No newline at end of file
+    // Antialias over the width of one fragment, whatever the scale of the text
+    float dist = texture(text, TexCoords).r;
+    float w = max(fwidth(dist), 1e-4);
+    float alpha = smoothstep(0.5 - w, 0.5 + w, dist);
+    color = vec4(TextColor, alpha);
+} 
@@ -3,15 +3,22 @@ layout (location = 0) in vec3 position; // The position variable has attribute p
 layout (location = 1) in vec3 color;	// The color variable has attribute position 1
 layout (location = 2) in vec2 texCoord;	// The texture variable has attribute position 2
 
+// Camera of the window being drawn (CameraUniforms, binding CAMERA_BLOCK_BINDING)
+layout (std140) uniform Camera{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;          // projection*view
+    vec2 viewportSize;      // Size of the viewport, pixels
+    float time;             // Time since the app started, seconds
+} camera;
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 out vec3 ourColor; // Output a color to the fragment shader
 out vec2 TexCoord;
 
 void main(){
-    gl_Position = projection * view * model * vec4(position, 1.0f);
+    gl_Position = camera.viewProj * model * vec4(position, 1.0f);
     ourColor = color; 								// Set ourColor to the input color we got from the vertex data
     TexCoord = vec2(texCoord.x, 1.0 - texCoord.y);	// Invert y-coordinate
 }
\ No newline at end of file
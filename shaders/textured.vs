@@ -1,4 +1,13 @@
 #version 330 core
+// Camera of the window being drawn (CameraUniforms, binding CAMERA_BLOCK_BINDING)
+layout (std140) uniform Camera{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;          // projection*view
+    vec2 viewportSize;      // Size of the viewport, pixels
+    float time;             // Time since the app started, seconds
+} camera;
+
 layout (location = 0) in vec3 position; // The position variable has attribute position 0
 layout (location = 1) in vec3 color;	// The color variable has attribute position 1
 layout (location = 2) in vec2 texCoord;	// The texture variable has attribute position 2
@@ -26,15 +26,21 @@
  *  You should have received a copy of the GNU General Public License
  *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
+#include <vector>
 
 #include <GL/glew.h>	// This header must be included BEFORE glfw3
 #include <GLFW/glfw3.h>
 
 #include <imgui/imgui.h>
+#include <imgui/imgui_internal.h>
 
 #include "App.hpp"
+#include "AtlasCache.hpp"
 #include "DemoWindow.hpp"
 #include "GLErrorHandling.hpp"
 #include "ResourceManager.hpp"
@@ -46,6 +52,48 @@ namespace gui{
 // Declare the global extern variable
 App* GLOBAL_APP = nullptr;
 
+/** Path that identifies the default (embedded) ImGui font; the atlas cache is written next to it */
+static const char IMGUI_FONT_PATH[] = "../fonts/imgui_default";
+
+/** Size at which ImGui rasterizes its default font, pixels (ImFontConfig::SizePixels) */
+static const float IMGUI_FONT_SIZE = 13.f;
+
+/**
+ *  @brief ImGui font data stored in the atlas cache, followed by the glyphs (ImFont::Glyph)
+ *  @details Everything ImFontAtlas::Build() computes other than the texels
+ */
+struct CachedImGuiFont{
+	float ascent;				//!< ImFont::Ascent
+	float descent;				//!< ImFont::Descent
+	float whitePixel[2];		//!< ImFontAtlas::TexUvWhitePixel
+	ImGuiMouseCursorData cursors[ImGuiMouseCursor_Count_];	//!< Location of the software mouse cursors in the atlas
+	uint32_t numGlyphs;			//!< Number of glyphs that follow
+};
+
+/**
+ *  @brief Compute the key of the ImGui font atlas cache
+ *  @details The cached metrics are copied into ImGui structures byte for byte,
+ *  so the key covers the layout of those structures and the compiler that laid
+ *  them out, in addition to the version of ImGui (which fixes the font)
+ *  @return the key
+ */
+static uint64_t getImGuiFontKey(){
+	std::ostringstream id;
+	id << IMGUI_VERSION << ' ' << sizeof(ImFont) << ' ' << sizeof(ImFont::Glyph) << ' ' << sizeof(ImFontConfig)
+		<< ' ' << sizeof(ImGuiMouseCursorData) << ' ' << sizeof(CachedImGuiFont) << ' ' << sizeof(void*);
+#if defined(__VERSION__)
+	id << ' ' << __VERSION__;
+#elif defined(_MSC_FULL_VER)
+	id << ' ' << _MSC_FULL_VER;
+#endif
+#if defined(__GXX_ABI_VERSION)
+	id << ' ' << __GXX_ABI_VERSION;
+#endif
+
+	std::string str = id.str();
+	return AtlasCache::hashBytes(str.c_str(), str.size());
+}//====================================================
+
 
 //-----------------------------------------------------
 //      *structors
@@ -136,21 +184,14 @@ void App::run(){
 	resourceMan->loadShader("../shaders/imgui.vs", "../shaders/imgui.frag", nullptr, "imgui");
 	resourceMan->loadShader("../shaders/line_thick.vs", "../shaders/line_thick.frag",
 		"../shaders/line_thick.geom", "line_thick");
+	resourceMan->loadShader("../shaders/line_batch.vs", "../shaders/line_thick.frag",
+		"../shaders/line_thick.geom", "line_batch");
+	resourceMan->loadShader("../shaders/line_thick_pull.vs", "../shaders/line_thick.frag", nullptr, "line_thick_pull");
 	resourceMan->loadShader("../shaders/textured.vs", "../shaders/textured.frag", nullptr, "textured");
 	resourceMan->loadShader("../shaders/colored.vs", "../shaders/colored.frag", nullptr, "colored");
 	resourceMan->loadShader("../shaders/basic.vert", "../shaders/basic.frag", nullptr, "basic");
 	
-	// Create a texture for ImGui Font
-	Texture2D tempTex;
-	ImGuiIO& io = ImGui::GetIO();
-	unsigned char* pixels;
-	int w, h;
-	io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);   // Load as RGBA 32-bits for OpenGL3 demo because it is more likely to be compatible with user's existing shader.
-	tempTex.internalFormat = GL_RGBA;
-	tempTex.imageFormat = GL_RGBA;
-	tempTex.generate(w, h, pixels);
-
-	resourceMan->addTexture("imguiFont", tempTex);
+	loadImGuiFont();
 
 	// Initialize all windows
 	for(auto& window : windows){
@@ -190,6 +231,101 @@ void App::run(){
 }//====================================================
 
 
+/**
+ *  @brief Create the texture for the ImGui font
+ *  @details The default font atlas is mapped from an AtlasCache when one was
+ *  written by an earlier run with the same version and build of ImGui (see
+ *  getImGuiFontKey()); otherwise, the atlas is built by ImGui and written to
+ *  the cache. Failure to write the cache is reported but is not an error.
+ */
+void App::loadImGuiFont(){
+	uint64_t key = getImGuiFontKey();
+	std::string cachePath = AtlasCache::getCachePath(IMGUI_FONT_PATH, IMGUI_FONT_SIZE);
+
+	Texture2D tempTex;
+	tempTex.internalFormat = GL_RGBA;
+	tempTex.imageFormat = GL_RGBA;
+
+	ImGuiIO& io = ImGui::GetIO();
+	ImFontAtlas *pAtlas = io.Fonts;
+	AtlasCache cache;
+	const CachedImGuiFont *pInfo = nullptr;
+	if(pAtlas->ConfigData.empty() && cache.open(cachePath.c_str(), key, IMGUI_FONT_SIZE) &&
+		cache.getBytesPerPixel() == 4 && cache.getMetricsSize() >= sizeof(CachedImGuiFont)){
+
+		pInfo = static_cast<const CachedImGuiFont*>(cache.getMetrics());
+		if(cache.getMetricsSize() != sizeof(CachedImGuiFont) + pInfo->numGlyphs*sizeof(ImFont::Glyph))
+			pInfo = nullptr;
+	}
+
+	if(pInfo){
+		// ImGui creates the font and its configuration itself (this only decodes
+		// the embedded TTF data); the cache then supplies what ImFontAtlas::Build()
+		// would compute, so nothing is rasterized
+		pAtlas->Clear();
+		ImFont *pFont = pAtlas->AddFontDefault();
+		ImFontConfig &cfg = pAtlas->ConfigData[0];
+
+		pFont->ContainerAtlas = pAtlas;
+		pFont->ConfigData = &cfg;
+		pFont->ConfigDataCount = 1;
+		pFont->FontSize = cfg.SizePixels;
+		pFont->Ascent = pInfo->ascent;
+		pFont->Descent = pInfo->descent;
+		pFont->FallbackGlyph = nullptr;
+		pFont->Glyphs.resize(static_cast<int>(pInfo->numGlyphs));
+		std::memcpy(pFont->Glyphs.Data, pInfo + 1, pInfo->numGlyphs*sizeof(ImFont::Glyph));
+		pFont->BuildLookupTable();
+
+		// Leave the texels where GetTexDataAsAlpha8() and GetTexDataAsRGBA32() expect them
+		int w = cache.getWidth(), h = cache.getHeight();
+		pAtlas->TexWidth = w;
+		pAtlas->TexHeight = h;
+		pAtlas->TexUvWhitePixel = ImVec2(pInfo->whitePixel[0], pInfo->whitePixel[1]);
+		pAtlas->TexPixelsRGBA32 = static_cast<unsigned int*>(ImGui::MemAlloc(static_cast<size_t>(w*h*4)));
+		pAtlas->TexPixelsAlpha8 = static_cast<unsigned char*>(ImGui::MemAlloc(static_cast<size_t>(w*h)));
+		std::memcpy(pAtlas->TexPixelsRGBA32, cache.getTexels(), static_cast<size_t>(w*h*4));
+		for(int i = 0; i < w*h; i++){
+			pAtlas->TexPixelsAlpha8[i] = static_cast<unsigned char>(pAtlas->TexPixelsRGBA32[i] >> 24);
+		}
+
+		// The software cursors are the only ImGui state outside the atlas that Build() sets
+		std::memcpy(GImGui->MouseCursorData, pInfo->cursors, sizeof(pInfo->cursors));
+
+		tempTex.generate(w, h, reinterpret_cast<const unsigned char*>(pAtlas->TexPixelsRGBA32));
+	}else{
+		unsigned char* pixels;
+		int w, h;
+		pAtlas->GetTexDataAsRGBA32(&pixels, &w, &h);   // Load as RGBA 32-bits for OpenGL3 demo because it is more likely to be compatible with user's existing shader.
+		tempTex.generate(w, h, pixels);
+
+		// Only the default font is cached; fonts added by the user are rebuilt every run
+		if(pAtlas->Fonts.Size == 1 && pAtlas->ConfigData.Size == 1 && pAtlas->ConfigData[0].SizePixels == IMGUI_FONT_SIZE &&
+			std::strcmp(pAtlas->ConfigData[0].Name, "<default>") == 0){
+
+			const ImFont *pFont = pAtlas->Fonts[0];
+			std::vector<unsigned char> metrics(sizeof(CachedImGuiFont) + pFont->Glyphs.Size*sizeof(ImFont::Glyph));
+			CachedImGuiFont info {};
+			info.ascent = pFont->Ascent;
+			info.descent = pFont->Descent;
+			info.whitePixel[0] = pAtlas->TexUvWhitePixel.x;
+			info.whitePixel[1] = pAtlas->TexUvWhitePixel.y;
+			std::memcpy(info.cursors, GImGui->MouseCursorData, sizeof(info.cursors));
+			info.numGlyphs = static_cast<uint32_t>(pFont->Glyphs.Size);
+			std::memcpy(&(metrics[0]), &info, sizeof(info));
+			std::memcpy(&(metrics[sizeof(info)]), pFont->Glyphs.Data, pFont->Glyphs.Size*sizeof(ImFont::Glyph));
+
+			try{
+				AtlasCache::write(cachePath.c_str(), key, IMGUI_FONT_SIZE, w, h, 4, pixels, &(metrics[0]), metrics.size());
+			}catch(std::exception &e){
+				std::cout << "App::loadImGuiFont: Could not write atlas cache: " << e.what() << std::endl;
+			}
+		}
+	}
+
+	resourceMan->addTexture("imguiFont", tempTex);
+}//====================================================
+
 //-----------------------------------------------------
 //      Set and Get Fucntions
 //-----------------------------------------------------
@@ -0,0 +1,323 @@
+/**
+ *  @file AtlasCache.cpp
+ *	@brief Binary cache of rasterized font atlases
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+ 
+/*
+ *	Astrohelion 
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *	
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AtlasCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace astrohelion{
+namespace gui{
+
+const char AtlasCache::MAGIC[8] = {'A', 'H', 'A', 'T', 'L', 'A', 'S', '\0'};
+const uint32_t AtlasCache::VERSION = 1;
+const uint64_t AtlasCache::HASH_SEED = 14695981039346656037ULL;
+
+/**
+ *  @brief Round a byte offset up to the next multiple of 16
+ *  @param offset byte offset
+ *  @return the aligned offset
+ */
+static uint64_t alignOffset(uint64_t offset){ return (offset + 15) & ~static_cast<uint64_t>(15); }
+
+/**
+ *  @brief Write zeros to a file until the write position reaches an offset
+ * 
+ *  @param fp file pointer
+ *  @param offset desired write position, bytes from the beginning of the file
+ *  @return whether or not the padding was written successfully
+ */
+static bool padFile(FILE *fp, uint64_t offset){
+	long pos = ftell(fp);
+	if(pos < 0 || static_cast<uint64_t>(pos) > offset)
+		return false;
+
+	const char zeros[16] = {0};
+	size_t numPad = static_cast<size_t>(offset - pos);
+	return fwrite(zeros, 1, numPad, fp) == numPad;
+}//====================================================
+
+//-----------------------------------------------------
+//      *structors
+//-----------------------------------------------------
+
+/**
+ *  @brief Construct an empty cache; nothing is mapped
+ */
+AtlasCache::AtlasCache(){}
+
+/**
+ *  @brief Unmap the cache file
+ */
+AtlasCache::~AtlasCache(){
+	close();
+}//====================================================
+
+//-----------------------------------------------------
+//      Action Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Map a cache file into memory
+ *  @details The file is rejected if it is missing, truncated, written by a different
+ *  format version, or built from a different font source or size.
+ * 
+ *  @param cachePath filepath to the cache file
+ *  @param key hash of the font source and build parameters; see hashFile()
+ *  @param size size at which the glyphs are rasterized, pixels
+ *  @return whether or not a valid cache was mapped
+ */
+bool AtlasCache::open(const char* cachePath, uint64_t key, float size){
+	close();
+
+#ifndef _WIN32
+	int fd = ::open(cachePath, O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(AtlasCacheHeader)){
+		::close(fd);
+		return false;
+	}
+
+	size_t fileSize = static_cast<size_t>(st.st_size);
+	void *pMap = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);	// The mapping remains valid after the file is closed
+
+	if(pMap == MAP_FAILED)
+		return false;
+
+	AtlasCacheHeader h;
+	std::memcpy(&h, pMap, sizeof(h));
+
+	bool valid = std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+		h.version == VERSION &&
+		h.key == key && h.size == size &&
+		h.width > 0 && h.height > 0 && h.bytesPerPixel > 0 &&
+		h.texelOffset + static_cast<uint64_t>(h.width)*h.height*h.bytesPerPixel <= fileSize &&
+		h.metricsOffset + h.metricsSize <= fileSize;
+
+	if(!valid){
+		munmap(pMap, fileSize);
+		return false;
+	}
+
+	pData = pMap;
+	dataSize = fileSize;
+	header = h;
+	return true;
+#else
+	(void) cachePath;
+	(void) key;
+	(void) size;
+	return false;
+#endif
+}//====================================================
+
+/**
+ *  @brief Unmap the cache file, if one is mapped
+ */
+void AtlasCache::close(){
+#ifndef _WIN32
+	if(pData)
+		munmap(pData, dataSize);
+#endif
+	pData = nullptr;
+	dataSize = 0;
+	header = AtlasCacheHeader();
+}//====================================================
+
+/**
+ *  @brief Write a cache file for a rasterized atlas
+ *  @details The file is written to a temporary path and then renamed so that a
+ *  partially written file is never mistaken for a valid cache.
+ * 
+ *  @param cachePath filepath to the cache file
+ *  @param key hash of the font source and build parameters; see hashFile()
+ *  @param size size at which the glyphs were rasterized, pixels
+ *  @param width width of the atlas, texels
+ *  @param height height of the atlas, texels
+ *  @param bytesPerPixel number of bytes stored for each texel
+ *  @param texels atlas texels, rows from the top with no padding between rows
+ *  @param metrics glyph metrics; may be nullptr if metricsSize is zero
+ *  @param metricsSize size of the glyph metrics, bytes
+ *  @throws std::runtime_error if the atlas is empty or the file cannot be written
+ */
+void AtlasCache::write(const char* cachePath, uint64_t key, float size, int width, int height, int bytesPerPixel,
+	const void* texels, const void* metrics, size_t metricsSize){
+
+	if(width <= 0 || height <= 0 || bytesPerPixel <= 0 || !texels)
+		throw std::runtime_error("AtlasCache::write: Atlas is empty");
+
+	AtlasCacheHeader h {};
+	std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+	h.version = VERSION;
+	h.bytesPerPixel = static_cast<uint32_t>(bytesPerPixel);
+	h.key = key;
+	h.size = size;
+	h.width = width;
+	h.height = height;
+
+	size_t numTexelBytes = static_cast<size_t>(width)*height*bytesPerPixel;
+	h.texelOffset = alignOffset(sizeof(AtlasCacheHeader));
+	h.metricsOffset = alignOffset(h.texelOffset + numTexelBytes);
+	h.metricsSize = metrics ? metricsSize : 0;
+
+	std::string tmpPath = std::string(cachePath) + ".tmp";
+	FILE *fp = fopen(tmpPath.c_str(), "wb");
+	if(!fp)
+		throw std::runtime_error("AtlasCache::write: Could not open cache file for writing");
+
+	bool ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+	ok = ok && padFile(fp, h.texelOffset) && fwrite(texels, 1, numTexelBytes, fp) == numTexelBytes;
+	ok = ok && padFile(fp, h.metricsOffset);
+	if(h.metricsSize > 0)
+		ok = ok && fwrite(metrics, 1, metricsSize, fp) == metricsSize;
+	ok = (fclose(fp) == 0) && ok;
+
+	if(!ok || std::rename(tmpPath.c_str(), cachePath) != 0){
+		std::remove(tmpPath.c_str());
+		throw std::runtime_error("AtlasCache::write: Failed to write cache file");
+	}
+}//====================================================
+
+/**
+ *  @brief Compute the 64-bit FNV-1a hash of a block of memory
+ *  @details Pass the hash of one block as the seed of the next to hash several
+ *  blocks as one
+ * 
+ *  @param pData pointer to the data
+ *  @param numBytes number of bytes to hash
+ *  @param seed initial value of the hash
+ *  @return the hash
+ */
+uint64_t AtlasCache::hashBytes(const void* pData, size_t numBytes, uint64_t seed){
+	const unsigned char *p = static_cast<const unsigned char*>(pData);
+	uint64_t hash = seed;
+	for(size_t i = 0; i < numBytes; i++){
+		hash ^= p[i];
+		hash *= 1099511628211ULL;	// 64-bit FNV prime
+	}
+	return hash;
+}//====================================================
+
+/**
+ *  @brief Compute the hash of the contents of a file
+ *  @details The file is read in blocks and hashed with hashBytes()
+ * 
+ *  @param path filepath
+ *  @param pHash receives the hash
+ *  @return whether or not the file could be read
+ */
+bool AtlasCache::hashFile(const char* path, uint64_t *pHash){
+	FILE *fp = fopen(path, "rb");
+	if(!fp)
+		return false;
+
+	uint64_t hash = HASH_SEED;
+	unsigned char buffer[1 << 16];
+	size_t numRead = 0;
+	while((numRead = fread(buffer, 1, sizeof(buffer), fp)) > 0){
+		hash = hashBytes(buffer, numRead, hash);
+	}
+	bool ok = !ferror(fp);
+	fclose(fp);
+
+	if(ok)
+		*pHash = hash;
+	return ok;
+}//====================================================
+
+//-----------------------------------------------------
+//      Set and Get Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Retrieve the cache filepath associated with a font
+ *  @param srcPath filepath to the font file, or any other path that identifies the font
+ *  @param size size at which the glyphs are rasterized, pixels
+ *  @return the cache filepath
+ */
+std::string AtlasCache::getCachePath(const char* srcPath, float size){
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), ".%g.atlascache", size);
+	return std::string(srcPath) + suffix;
+}//====================================================
+
+/**
+ *  @brief Retrieve the number of bytes stored for each texel
+ *  @return the number of bytes stored for each texel, or zero if no cache is mapped
+ */
+int AtlasCache::getBytesPerPixel() const { return static_cast<int>(header.bytesPerPixel); }
+
+/**
+ *  @brief Retrieve the height of the atlas
+ *  @return the height of the atlas, texels, or zero if no cache is mapped
+ */
+int AtlasCache::getHeight() const { return header.height; }
+
+/**
+ *  @brief Retrieve a pointer to the glyph metrics
+ *  @return a pointer to the glyph metrics, or nullptr if no cache is mapped
+ */
+const void* AtlasCache::getMetrics() const{
+	return pData ? static_cast<const char*>(pData) + header.metricsOffset : nullptr;
+}//====================================================
+
+/**
+ *  @brief Retrieve the size of the glyph metrics
+ *  @return the size of the glyph metrics, bytes
+ */
+size_t AtlasCache::getMetricsSize() const { return static_cast<size_t>(header.metricsSize); }
+
+/**
+ *  @brief Retrieve a pointer to the atlas texels
+ *  @return a pointer to the texels (rows from the top), or nullptr if no cache is mapped
+ */
+const unsigned char* AtlasCache::getTexels() const{
+	return pData ? static_cast<const unsigned char*>(pData) + header.texelOffset : nullptr;
+}//====================================================
+
+/**
+ *  @brief Retrieve the width of the atlas
+ *  @return the width of the atlas, texels, or zero if no cache is mapped
+ */
+int AtlasCache::getWidth() const { return header.width; }
+
+}// End of gui namespace
+}// End of astrohelion namespace
@@ -0,0 +1,367 @@
+/**
+ *  @file BillboardClusterer.cpp
+ *	@brief Zoom-dependent clustering of billboard markers
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+
+/*
+ *	Astrohelion
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BillboardClusterer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "BillboardSet.hpp"
+#include "Frustum.hpp"
+
+namespace astrohelion{
+namespace gui{
+
+const float BillboardClusterer::DEFAULT_MIN_SEPARATION = 20.f;
+
+/** Maximum number of markers stored in a leaf node */
+static const size_t CLUSTER_LEAF_SIZE = 8;
+
+/** Maximum number of cluster candidates per cell of the screen grid */
+static const size_t CLUSTER_BUDGET_PER_CELL = 4;
+
+//-----------------------------------------------------
+//      *structors
+//-----------------------------------------------------
+
+/**
+ *  @brief Construct an empty clusterer
+ */
+BillboardClusterer::BillboardClusterer() : markerRadius(BillboardSet::DEFAULT_RADIUS) {}
+
+//-----------------------------------------------------
+//      Action Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Build the hierarchy over a set of markers
+ *  @details Nodes are split at the median marker along the longest axis of
+ *  the node. The clusters are recomputed by the next call to update().
+ * 
+ *  @param pts marker positions (x, y, z for each marker), world coordinates
+ *  @param cols marker colors (RGBA for each marker)
+ *  @throws std::runtime_error if the number of colors does not match the number of positions
+ */
+void BillboardClusterer::build(const std::vector<float> &pts, const std::vector<float> &cols){
+	if(pts.size() % 3 != 0 || cols.size()/4 != pts.size()/3)
+		throw std::runtime_error("BillboardClusterer::build: Each marker must have a position and a color");
+
+	clear();
+	markerPoints = pts;
+	markerColors = cols;
+
+	order.resize(pts.size()/3);
+	for(size_t i = 0; i < order.size(); i++){
+		order[i] = i;
+	}
+
+	if(!order.empty()){
+		nodes.reserve(2*order.size()/CLUSTER_LEAF_SIZE + 1);
+		buildNode(0, order.size());
+	}
+}//====================================================
+
+/**
+ *  @brief Remove every marker and cluster
+ */
+void BillboardClusterer::clear(){
+	markerPoints.clear();
+	markerColors.clear();
+	order.clear();
+	nodes.clear();
+	points.clear();
+	colors.clear();
+	radii.clear();
+	counts.clear();
+	cells.clear();
+	usedCells.clear();
+	bValid = false;
+}//====================================================
+
+/**
+ *  @brief Force the next call to update() to recompute the clusters
+ */
+void BillboardClusterer::invalidate(){ bValid = false; }
+
+/**
+ *  @brief Recompute the clusters for a view
+ *  @details Nothing is done if the view and viewport are unchanged since the
+ *  previous update. Otherwise, the hierarchy is descended until a node is
+ *  outside the view frustum, is smaller than the minimum separation on
+ *  screen (it becomes a cluster candidate at its mean position), or is a leaf
+ *  (each of its markers becomes a candidate). Candidates in front of the
+ *  camera and inside the viewport are then merged per cell of a screen grid.
+ *  When the markers are dense on screen, the descent stops once there are a
+ *  few candidates per cell, and the unvisited nodes become candidates; the
+ *  cost of an update is therefore bounded by the area of the viewport.
+ *  
+ *  The radius of each cluster grows with the logarithm of its count so that
+ *  large clusters stand out.
+ * 
+ *  @param view view matrix, e.g., from CameraFPS::getViewMatrix()
+ *  @param projection perspective projection matrix
+ *  @param viewport size of the viewport, pixels
+ *  @return whether the clusters were recomputed
+ */
+bool BillboardClusterer::update(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec2 &viewport){
+	glm::mat4 viewProj = projection*view;
+	if(bValid && viewProj == lastViewProj && viewport == lastViewport)
+		return false;
+
+	lastViewProj = viewProj;
+	lastViewport = viewport;
+	bValid = true;
+
+	points.clear();
+	colors.clear();
+	radii.clear();
+	counts.clear();
+	if(nodes.empty() || viewport.x < 1 || viewport.y < 1)
+		return true;
+
+	// Screen grid; each cell has the size of the minimum separation. The cells
+	// are reused between updates, so only the ones filled last time are reset
+	int cols = static_cast<int>(std::ceil(viewport.x/minSeparation));
+	int rows = static_cast<int>(std::ceil(viewport.y/minSeparation));
+	for(size_t c : usedCells){
+		if(c < cells.size())
+			cells[c] = Cell();
+	}
+	usedCells.clear();
+	cells.resize(static_cast<size_t>(cols)*rows);
+
+	// Adds a candidate with the specified count to the grid
+	auto addCandidate = [&](const glm::vec3 &pos, const glm::vec4 &color, size_t count){
+		glm::vec4 clip = viewProj*glm::vec4(pos, 1.f);
+		if(clip.w <= 0)
+			return;
+
+		glm::vec2 px = (0.5f*glm::vec2(clip)/clip.w + 0.5f)*viewport;
+		int cx = static_cast<int>(std::floor(px.x/minSeparation));
+		int cy = static_cast<int>(std::floor(px.y/minSeparation));
+		if(cx < 0 || cx >= cols || cy < 0 || cy >= rows)
+			return;
+
+		Cell &cell = cells[static_cast<size_t>(cy)*cols + cx];
+		if(cell.count == 0)
+			usedCells.push_back(static_cast<size_t>(cy)*cols + cx);
+
+		cell.pos += static_cast<float>(count)*pos;
+		cell.color += static_cast<float>(count)*color;
+		cell.count += count;
+	};
+
+	glm::vec3 eye(glm::inverse(view)[3]);
+	Frustum frustum(viewProj);
+	float pxPerUnitDist = 0.5f*projection[1][1]*viewport.y;	// Pixels spanned by one world unit at a distance of one unit
+
+	// Breadth-first, so that the budget (if reached) leaves the whole view equally refined
+	size_t budget = CLUSTER_BUDGET_PER_CELL*cells.size();
+	size_t numCandidates = 0;
+	std::vector<int> queue(1, 0);
+	for(size_t q = 0; q < queue.size(); q++){
+		const Node &node = nodes[queue[q]];
+		if(!frustum.intersects(node.lo, node.hi))
+			continue;
+
+		float dist = glm::length(eye - glm::clamp(eye, node.lo, node.hi));
+		bool bSmall = dist > 0 && glm::length(node.hi - node.lo)*pxPerUnitDist/dist <= minSeparation;
+		size_t numPending = queue.size() - q - 1;
+		bool bOverBudget = numCandidates + numPending + (node.left < 0 ? node.count : 2) > budget;
+
+		if(bSmall || bOverBudget){
+			addCandidate(node.center, node.color, node.count);
+			numCandidates++;
+		}else if(node.left < 0){
+			for(size_t i = node.first; i < node.first + node.count; i++){
+				size_t m = order[i];
+				addCandidate(getPosition(m), glm::vec4(markerColors[4*m], markerColors[4*m+1],
+					markerColors[4*m+2], markerColors[4*m+3]), 1);
+			}
+			numCandidates += node.count;
+		}else{
+			queue.push_back(node.left);
+			queue.push_back(node.right);
+		}
+	}
+
+	// Keep the output in a stable order so that clusters do not flicker when the view changes slightly
+	std::sort(usedCells.begin(), usedCells.end());
+	points.reserve(3*usedCells.size());
+	colors.reserve(4*usedCells.size());
+	radii.reserve(usedCells.size());
+	counts.reserve(usedCells.size());
+	for(size_t c : usedCells){
+		const Cell &cell = cells[c];
+		glm::vec3 pos = cell.pos/static_cast<float>(cell.count);
+		glm::vec4 color = cell.color/static_cast<float>(cell.count);
+
+		points.insert(points.end(), {pos.x, pos.y, pos.z});
+		colors.insert(colors.end(), {color.r, color.g, color.b, color.a});
+		radii.push_back(markerRadius*(1.f + 0.5f*std::log10(static_cast<float>(cell.count))));
+		counts.push_back(cell.count);
+	}
+
+	return true;
+}//====================================================
+
+//-----------------------------------------------------
+//      Set and Get Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Retrieve the color of each cluster
+ *  @return the color of each cluster (RGBA), the mean of the colors of its markers
+ */
+const std::vector<float>& BillboardClusterer::getColors() const { return colors; }
+
+/**
+ *  @brief Retrieve the number of markers in each cluster
+ *  @return the number of markers in each cluster
+ */
+const std::vector<unsigned int>& BillboardClusterer::getCounts() const { return counts; }
+
+/**
+ *  @brief Retrieve the radius of a cluster that contains one marker
+ *  @return the radius of a cluster that contains one marker, pixels
+ */
+float BillboardClusterer::getMarkerRadius() const { return markerRadius; }
+
+/**
+ *  @brief Retrieve the minimum separation between clusters
+ *  @return the minimum separation between clusters, pixels
+ */
+float BillboardClusterer::getMinSeparation() const { return minSeparation; }
+
+/**
+ *  @brief Retrieve the number of clusters computed by the most recent update()
+ *  @return the number of clusters computed by the most recent update()
+ */
+size_t BillboardClusterer::getNumClusters() const { return counts.size(); }
+
+/**
+ *  @brief Retrieve the number of markers passed to build()
+ *  @return the number of markers passed to build()
+ */
+size_t BillboardClusterer::getNumMarkers() const { return order.size(); }
+
+/**
+ *  @brief Retrieve the position of each cluster
+ *  @return the position of each cluster (x, y, z), world coordinates
+ */
+const std::vector<float>& BillboardClusterer::getPoints() const { return points; }
+
+/**
+ *  @brief Retrieve the radius of each cluster
+ *  @return the radius of each cluster, pixels
+ */
+const std::vector<float>& BillboardClusterer::getRadii() const { return radii; }
+
+/**
+ *  @brief Set the radius of a cluster that contains one marker
+ *  @param r radius, pixels
+ */
+void BillboardClusterer::setMarkerRadius(float r){
+	markerRadius = r;
+	bValid = false;
+}//====================================================
+
+/**
+ *  @brief Set the minimum separation between clusters
+ *  @param px separation, pixels; values less than one pixel are set to one pixel
+ */
+void BillboardClusterer::setMinSeparation(float px){
+	minSeparation = std::max(px, 1.f);
+	bValid = false;
+}//====================================================
+
+//-----------------------------------------------------
+//      Utility Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Create a node for a range of the order array and, recursively, its children
+ * 
+ *  @param first index of the first marker of the node in order
+ *  @param count number of markers in the node
+ *  @return the index of the new node
+ */
+int BillboardClusterer::buildNode(size_t first, size_t count){
+	int ix = static_cast<int>(nodes.size());
+	nodes.push_back(Node());
+
+	Node node;
+	node.first = first;
+	node.count = count;
+	node.lo = node.hi = getPosition(order[first]);
+
+	glm::dvec3 posSum(0);
+	glm::dvec4 colorSum(0);
+	for(size_t i = first; i < first + count; i++){
+		size_t m = order[i];
+		glm::vec3 pos = getPosition(m);
+		node.lo = glm::min(node.lo, pos);
+		node.hi = glm::max(node.hi, pos);
+
+		posSum += glm::dvec3(pos);
+		colorSum += glm::dvec4(markerColors[4*m], markerColors[4*m+1], markerColors[4*m+2], markerColors[4*m+3]);
+	}
+	node.center = glm::vec3(posSum/static_cast<double>(count));
+	node.color = glm::vec4(colorSum/static_cast<double>(count));
+
+	if(count > CLUSTER_LEAF_SIZE){
+		glm::vec3 extent = node.hi - node.lo;
+		int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+		std::vector<size_t>::iterator itFirst = order.begin() + first;
+		std::vector<size_t>::iterator itMid = itFirst + count/2;
+		std::nth_element(itFirst, itMid, itFirst + count, [this, axis](size_t a, size_t b){
+			return markerPoints[3*a + axis] < markerPoints[3*b + axis];
+		});
+
+		node.left = buildNode(first, count/2);
+		node.right = buildNode(first + count/2, count - count/2);
+	}
+
+	nodes[ix] = node;
+	return ix;
+}//====================================================
+
+/**
+ *  @brief Retrieve the position of a marker
+ *  @param m index of the marker
+ *  @return the position of the marker, world coordinates
+ */
+glm::vec3 BillboardClusterer::getPosition(size_t m) const{
+	return glm::vec3(markerPoints[3*m], markerPoints[3*m+1], markerPoints[3*m+2]);
+}//====================================================
+
+}// End of gui namespace
+}// End of astrohelion namespace
@@ -31,67 +31,693 @@
 #include <glm/glm.hpp>
 
 #include "assert.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 
 #include "App.hpp"
 #include "ResourceManager.hpp"
 #include "BillboardSet.hpp"
+#include "Shader.hpp"
 
 namespace astrohelion{
 namespace gui{
 
+const float BillboardSet::DEFAULT_RADIUS = 20.f;
+
+BillboardSet::BillboardUniforms BillboardSet::uniforms {};
+
+/**
+ *  @brief Attach a buffer object to a buffer texture and bind it
+ *  @details The buffer is reattached every time because the owner of the
+ *  buffer (e.g., a Polyline) may replace or reformat it at any time
+ * 
+ *  @param unit texture unit, e.g., GL_TEXTURE0
+ *  @param buffer buffer object to expose
+ *  @param format internal format of each texel, e.g., GL_R32F
+ *  @param tex buffer texture; created if zero
+ */
+static void bindBufferTexture(GLenum unit, GLuint buffer, GLenum format, GLuint &tex){
+	if(tex == 0)
+		glGenTextures(1, &tex);
+
+	glActiveTexture(unit);
+	glBindTexture(GL_TEXTURE_BUFFER, tex);
+	glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+}//====================================================
+
 BillboardSet::BillboardSet(){}
 
-BillboardSet::BillboardSet(std::vector<float> points, std::vector<float> colors){
+/**
+ *  @brief Construct a set of billboards
+ *  @details The billboards are not uploaded until init() is called
+ * 
+ *  @param points billboard positions (x, y, z for each billboard), world coordinates
+ *  @param colors billboard colors (RGBA for each billboard)
+ *  @param radii radius of each billboard, pixels; if empty, every billboard
+ *  has a radius of DEFAULT_RADIUS
+ */
+BillboardSet::BillboardSet(std::vector<float> points, std::vector<float> colors, std::vector<float> radii){
 	this->points = points;
 	this->colors = colors;
 	assert(points.size() >= 3);
 	assert(colors.size()/4 == points.size()/3);
 	numPoints = points.size()/3;
+
+	this->radii = radii.empty() ? std::vector<float>(numPoints, DEFAULT_RADIUS) : radii;
+	assert(this->radii.size() == numPoints);
 }//====================================================
 
-void BillboardSet::init(){
+/**
+ *  @brief Upload the billboards to the GPU
+ *  @details Billboards with 32-bit positions store 20 bytes per instance.
+ *  Quantized billboards store 16: the position is encoded as 16-bit offsets
+ *  within a chunk (see quantizePositions()), which billboard.vert decodes.
+ * 
+ *  @param enc Format of the positions stored on the GPU
+ */
+void BillboardSet::init(VertexEncoding_tp enc){
 	if(points.size() < 3)
 		return;
 
+	encoding = enc;
+	if(encoding == VertexEncoding_tp::QUANTIZED16){
+		initQuantized();
+		return;
+	}
+
+	std::vector<Instance> instances(numPoints);
 	for(unsigned int p = 0; p < numPoints; p++){
-		vertexData.insert(vertexData.end(), points.begin() + p*3, points.begin() + (p+1)*3);
-		vertexData.insert(vertexData.end(), colors.begin() + p*4, colors.begin() + (p+1)*4);
+		std::copy(points.begin() + 3*p, points.begin() + 3*p + 3, instances[p].pos);
+		packColor(p, instances[p].color);
+		instances[p].radius = radii[p];
 	}
 
-	for(unsigned int i = 0; i < vertexData.size(); i++){
-		printf("%.2f ", vertexData[i]);
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+
+	glBindVertexArray(VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size()*sizeof(Instance), &(instances[0]), GL_STATIC_DRAW);
+    setInstanceAttribs(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);   // Note that this is allowed, the call to glVertexAttribPointer registered VBO as the currently bound vertex buffer object so afterwards we can safely unbind
+    glBindVertexArray(0);   // Unbind VAO (it's always a good thing to unbind any buffer/array to prevent strange bugs)
+}//====================================================
+
+/**
+ *  @brief Allocate GPU storage for billboards that are updated every frame
+ *  @details The instance buffer is split into NUM_REGIONS regions of
+ *  <tt>cap</tt> billboards each. Every frame, the first call to update() moves
+ *  to the next region, waits on the fence placed after that region was last
+ *  drawn (normally already signaled, since NUM_REGIONS - 1 frames have passed),
+ *  and brings it up to date with the updates it missed; draw() then reads
+ *  from that region. The buffer is persistently mapped when ARB_buffer_storage
+ *  is available so that updates are written directly to GPU memory.
+ *  
+ *  Billboards passed to the constructor are uploaded as the initial contents;
+ *  billboards beyond them are added by update(). Positions are always stored
+ *  as 32-bit floats.
+ * 
+ *  @param cap Maximum number of billboards in the set
+ *  @throws std::runtime_error if the capacity is zero or the buffer cannot be mapped
+ */
+void BillboardSet::initDynamic(size_t cap){
+	destroy();
+
+	cap = std::max(cap, static_cast<size_t>(numPoints));
+	if(cap == 0)
+		throw std::runtime_error("BillboardSet::initDynamic: Capacity must be positive");
+
+	bDynamic = true;
+	encoding = VertexEncoding_tp::FLOAT32;
+	capacity = cap;
+	points.resize(3*cap, 0.f);
+	colors.resize(4*cap, 1.f);
+	radii.resize(cap, DEFAULT_RADIUS);
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+	GLsizeiptr bytes = NUM_REGIONS*cap*sizeof(Instance);
+	if(GLEW_ARB_buffer_storage){
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, flags);
+		pMapped = static_cast<Instance*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags));
+
+		if(!pMapped){
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			glBindVertexArray(0);
+			destroy();
+			throw std::runtime_error("BillboardSet::initDynamic: Could not map buffer storage");
+		}
+		bPersistent = true;
+	}else{
+		glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
 	}
-	printf("\n");
+	setInstanceAttribs(0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	// Every region is missing the initial billboards; the first region is filled now
+	for(unsigned int r = 0; r < NUM_REGIONS; r++)
+		staleRanges[r] = SegmentRange(0, numPoints);
 
+	region = NUM_REGIONS - 1;
+	acquireRegion();
+}//====================================================
+
+/**
+ *  @brief Mark every <tt>stride</tt>-th node of a line, starting at node <tt>first</tt>
+ *  @details The set reads the positions directly from the vertex buffer of
+ *  the line, in either encoding, so no vertex data are copied or uploaded.
+ *  The markers follow the line as it grows or is modified, but the line must
+ *  outlive the set (or the set must be destroyed first). Every marker has the
+ *  color and radius set by setColor() and setRadius().
+ * 
+ *  @param pL line to mark
+ *  @param first index of the first marked node
+ *  @param stride number of nodes between consecutive markers
+ *  @throws std::runtime_error if the line is null or the stride is zero
+ */
+void BillboardSet::initFromLine(const Polyline *pL, size_t first, size_t stride){
+	if(!pL || stride == 0)
+		throw std::runtime_error("BillboardSet::initFromLine: Invalid line or stride");
+
+	destroy();
+	points.clear();
+	colors.clear();
+	radii.clear();
+
+	pLine = pL;
+	lineFirst = first;
+	lineStride = stride;
+	bLineIndexed = false;
+	if(markerRadius <= 0)
+		markerRadius = DEFAULT_RADIUS;
+
+	// Every attribute is either pulled from the line or constant, so the VAO has no arrays
 	glGenVertexArrays(1, &VAO);
+}//====================================================
+
+/**
+ *  @brief Mark a subset of the nodes of a line
+ *  @details As initFromLine(const Polyline*, size_t, size_t), but the marked
+ *  nodes are listed explicitly; the set stores one unsigned int per marker.
+ * 
+ *  @param pL line to mark
+ *  @param nodes indices of the marked nodes
+ *  @throws std::runtime_error if the line is null
+ *  @throws std::out_of_range if a node index is not on the line
+ */
+void BillboardSet::initFromLine(const Polyline *pL, const std::vector<unsigned int> &nodes){
+	if(!pL)
+		throw std::runtime_error("BillboardSet::initFromLine: Invalid line");
+
+	for(unsigned int n : nodes){
+		if(n >= pL->getNumPoints())
+			throw std::out_of_range("BillboardSet::initFromLine: Node index is out of range");
+	}
+
+	initFromLine(pL, 0, 1);
+	bLineIndexed = true;
+	numPoints = nodes.size();
+	if(nodes.empty())
+		return;
+
 	glGenBuffers(1, &VBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, nodes.size()*sizeof(GLuint), &(nodes[0]), GL_STATIC_DRAW);
+
+	// Location 4: Node index (integer)
+	glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(GLuint), (GLvoid*)0);
+	glEnableVertexAttribArray(4);
+	glVertexAttribDivisor(4, 1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}//====================================================
+
+/**
+ *  @brief Delete the OpenGL objects owned by the set
+ *  @details As with Polyline, the objects are not deleted automatically because
+ *  the set may be copied; call this function from the thread that owns the
+ *  OpenGL context once the set is no longer needed.
+ */
+void BillboardSet::destroy(){
+	for(unsigned int r = 0; r < NUM_REGIONS; r++){
+		if(regionFences[r]){
+			glDeleteSync(regionFences[r]);
+			regionFences[r] = 0;
+		}
+	}
+
+	if(VAO != 0){
+		if(bPersistent && pMapped){
+			glBindBuffer(GL_ARRAY_BUFFER, VBO);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
 
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+	}
+	if(chunkTexture != 0)
+		glDeleteTextures(1, &chunkTexture);
+	if(chunkBuffer != 0)
+		glDeleteBuffers(1, &chunkBuffer);
+	if(lineTexture != 0)
+		glDeleteTextures(1, &lineTexture);
+
+	VAO = VBO = chunkBuffer = chunkTexture = lineTexture = 0;
+	pLine = nullptr;
+	bLineIndexed = false;
+	bDynamic = false;
+	bPersistent = false;
+	bRegionOpen = false;
+	pMapped = nullptr;
+	capacity = 0;
+}//====================================================
+
+/**
+ *  @brief Draw the billboards
+ *  @details Every billboard is drawn with one instanced call. The camera is
+ *  read from the Camera uniform block (see Window::uploadCameraUniforms()); the
+ *  "offset" uniform of the "billboard" shader must be set by the caller. Blending is enabled while drawing so that the edges of the shapes
+ *  are antialiased.
+ *  
+ *  A dynamic set draws from the region written by the most recent update()
+ *  and places a fence so that the region is not overwritten until the GPU
+ *  has finished reading it.
+ *  
+ *  A set that marks the nodes of a line pulls the positions from the line's
+ *  vertex buffer through a buffer texture; the color and radius are passed as
+ *  constant vertex attributes.
+ */
+void BillboardSet::draw(){
+	if(pLine){
+		if(pLine->getVBO() == 0)
+			return;
+
+		encoding = pLine->getEncoding();
+		if(!bLineIndexed)
+			numPoints = static_cast<unsigned int>(countLineNodes());
+	}
+
+	if(VAO == 0 || numPoints == 0)
+		return;
+
+	Shader &shader = GLOBAL_APP->getResMan()->getShader("billboard");
+	resolveUniforms(shader);
+	shader.setInteger(uniforms.bQuantized, encoding == VertexEncoding_tp::QUANTIZED16 ? 1 : 0, true);
+	shader.setInteger(uniforms.shape, static_cast<int>(shape));
+	shader.setInteger(uniforms.bLineNodes, pLine ? 1 : 0);
+	if(pLine){
+		bool bQuant = encoding == VertexEncoding_tp::QUANTIZED16;
+		shader.setInteger(uniforms.lineVertices, 1);
+		shader.setInteger(uniforms.bLineIndexed, bLineIndexed ? 1 : 0);
+		shader.setInteger(uniforms.nodeFirst, static_cast<int>(lineFirst));
+		shader.setInteger(uniforms.nodeStride, static_cast<int>(lineStride));
+		bindBufferTexture(GL_TEXTURE1, pLine->getVBO(), bQuant ? GL_RGBA16 : GL_R32F, lineTexture);
+		if(bQuant)
+			bindBufferTexture(GL_TEXTURE0, pLine->getChunkBuffer(), GL_RGBA32F, chunkTexture);
+
+		// Generic values of the attributes that have no array in the VAO
+		glVertexAttrib4fv(1, markerColor);
+		glVertexAttrib1f(3, markerRadius);
+	}
+	if(encoding == VertexEncoding_tp::QUANTIZED16){
+		shader.setInteger(uniforms.chunkTable, 0);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_BUFFER, chunkTexture);
+	}
+
+	GLboolean bBlendWasEnabled = glIsEnabled(GL_BLEND);
+	if(!bBlendWasEnabled){
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+
+	// Four corners per billboard, generated from gl_VertexID
 	glBindVertexArray(VAO);
+	if(bDynamic){
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		setInstanceAttribs(region*capacity*sizeof(Instance));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, numPoints);
+    glBindVertexArray(0);
+
+	if(bDynamic){
+		if(regionFences[region])
+			glDeleteSync(regionFences[region]);
+		regionFences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		bRegionOpen = false;
+	}
+
+	if(!bBlendWasEnabled)
+		glDisable(GL_BLEND);
+
+	if(pLine){
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+		glActiveTexture(GL_TEXTURE0);
+	}
+	if(encoding == VertexEncoding_tp::QUANTIZED16)
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+}//====================================================
+
+/**
+ *  @brief Update a contiguous span of billboards in a dynamic set
+ *  @details The span is written directly to the region that the next draw()
+ *  reads; the other regions receive it when they are next acquired. Any
+ *  number of spans may be updated between draws. The set grows to include
+ *  the span if it ends beyond the current number of billboards.
+ * 
+ *  @param first index of the first billboard to update
+ *  @param count number of billboards to update
+ *  @param pts positions (x, y, z for each of the <tt>count</tt> billboards), world coordinates
+ *  @param cols colors (RGBA for each billboard); if nullptr, the colors are not changed
+ *  @param r radius of each billboard, pixels; if nullptr, the radii are not changed
+ *  @throws std::runtime_error if the set was not initialized by initDynamic()
+ *  @throws std::out_of_range if the span extends beyond the capacity of the set
+ */
+void BillboardSet::update(size_t first, size_t count, const float *pts, const float *cols, const float *r){
+	if(!bDynamic)
+		throw std::runtime_error("BillboardSet::update: The set was not initialized by initDynamic()");
 
+	if(first + count > capacity)
+		throw std::out_of_range("BillboardSet::update: Span extends beyond the capacity of the set");
+
+	if(count == 0)
+		return;
+
+	std::copy(pts, pts + 3*count, points.begin() + 3*first);
+	if(cols)
+		std::copy(cols, cols + 4*count, colors.begin() + 4*first);
+	if(r)
+		std::copy(r, r + count, radii.begin() + first);
+	numPoints = std::max(numPoints, static_cast<unsigned int>(first + count));
+
+	// The span is written below, so the new region only needs the rest of its stale range
+	if(!bRegionOpen)
+		acquireRegion(first, count);
+
+	writeInstances(region, first, count);
+
+	for(unsigned int i = 0; i < NUM_REGIONS; i++){
+		if(i == region)
+			continue;
+
+		SegmentRange &stale = staleRanges[i];
+		if(stale.count == 0){
+			stale = SegmentRange(first, count);
+		}else{
+			size_t end = std::max(stale.first + stale.count, first + count);
+			stale.first = std::min(stale.first, first);
+			stale.count = end - stale.first;
+		}
+	}
+}//====================================================
+
+/**
+ *  @brief Retrieve the maximum number of billboards in a dynamic set
+ *  @return the capacity passed to initDynamic(), or zero if the set is not dynamic
+ */
+size_t BillboardSet::getCapacity() const { return capacity; }
+
+/**
+ *  @brief Retrieve the number of billboards
+ *  @return the number of billboards; for a set that marks a stride of the
+ *  nodes of a line, the number of nodes currently marked
+ */
+size_t BillboardSet::getNumPoints() const { return pLine && !bLineIndexed ? countLineNodes() : numPoints; }
+
+/**
+ *  @brief Retrieve the shape drawn for every billboard
+ *  @return the shape drawn for every billboard
+ */
+BillboardShape_tp BillboardSet::getShape() const { return shape; }
+
+/**
+ *  @brief Determine whether the set was initialized by initDynamic()
+ *  @return whether the set was initialized by initDynamic()
+ */
+bool BillboardSet::isDynamic() const { return bDynamic; }
+
+/**
+ *  @brief Set the color of every marker in a set initialized by initFromLine()
+ *  @details Sets constructed from points store a color per billboard; this
+ *  color is ignored by them
+ * 
+ *  @param r red value, between 0 and 1
+ *  @param g green value, between 0 and 1
+ *  @param b blue value, between 0 and 1
+ *  @param a alpha value, between 0 and 1
+ */
+void BillboardSet::setColor(float r, float g, float b, float a){
+	markerColor[0] = r;
+	markerColor[1] = g;
+	markerColor[2] = b;
+	markerColor[3] = a;
+}//====================================================
+
+/**
+ *  @brief Set the number of billboards drawn from a dynamic set
+ *  @details Billboards beyond the new count are kept and are drawn again if
+ *  the count is increased, e.g., by update()
+ * 
+ *  @param n number of billboards
+ *  @throws std::runtime_error if the set was not initialized by initDynamic()
+ *  @throws std::out_of_range if n exceeds the capacity of the set
+ */
+void BillboardSet::setNumPoints(size_t n){
+	if(!bDynamic)
+		throw std::runtime_error("BillboardSet::setNumPoints: The set was not initialized by initDynamic()");
+
+	if(n > capacity)
+		throw std::out_of_range("BillboardSet::setNumPoints: Count exceeds the capacity of the set");
+
+	numPoints = static_cast<unsigned int>(n);
+}//====================================================
+
+/**
+ *  @brief Set the radius of every marker in a set initialized by initFromLine()
+ *  @param r radius, pixels
+ */
+void BillboardSet::setRadius(float r){ markerRadius = r; }
+
+/**
+ *  @brief Set the shape drawn for every billboard
+ *  @details The shape is applied as a uniform, so it may be changed at any time
+ *  @param s shape
+ */
+void BillboardSet::setShape(BillboardShape_tp s){ shape = s; }
+
+/**
+ *  @brief Move a dynamic set to the next region of the instance buffer
+ *  @details Waits until the GPU has finished the last draw from the region
+ *  (three frames ago when the set is updated every frame), then copies the
+ *  billboards updated since the region was last written, except for a span
+ *  that the caller is about to write anyway.
+ * 
+ *  @param skipFirst index of the first billboard that is not copied
+ *  @param skipCount number of billboards that are not copied
+ */
+void BillboardSet::acquireRegion(size_t skipFirst, size_t skipCount){
+	region = (region + 1) % NUM_REGIONS;
+
+	if(regionFences[region]){
+		GLenum result = glClientWaitSync(regionFences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);	// 1 second timeout
+		if(result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED)
+			printf("BillboardSet::acquireRegion: Warning: Draw fence was not signaled; data may be overwritten while in use\n");
+
+		glDeleteSync(regionFences[region]);
+		regionFences[region] = 0;
+	}
+
+	SegmentRange &stale = staleRanges[region];
+	size_t staleEnd = stale.first + stale.count, skipEnd = skipFirst + skipCount;
+	if(skipCount == 0 || skipEnd <= stale.first || skipFirst >= staleEnd){
+		if(stale.count > 0)
+			writeInstances(region, stale.first, stale.count);
+	}else{
+		// Copy only the parts of the stale range before and after the skipped span
+		if(stale.first < skipFirst)
+			writeInstances(region, stale.first, skipFirst - stale.first);
+		if(skipEnd < staleEnd)
+			writeInstances(region, skipEnd, staleEnd - skipEnd);
+	}
+	stale = SegmentRange();
+
+	bRegionOpen = true;
+}//====================================================
+
+/**
+ *  @brief Count the nodes marked by a set that marks a stride of the nodes of a line
+ *  @return the number of marked nodes on the line in its current state
+ */
+size_t BillboardSet::countLineNodes() const{
+	size_t n = pLine->getNumPoints();
+	return n > lineFirst ? (n - lineFirst + lineStride - 1)/lineStride : 0;
+}//====================================================
+
+/**
+ *  @brief Upload the billboards with quantized positions
+ *  @details Each instance stores x, y, z, and the chunk index as unsigned shorts,
+ *  followed by the RGBA color as unsigned bytes and the radius as a float
+ */
+void BillboardSet::initQuantized(){
+	std::vector<unsigned short> q;
+	std::vector<float> chunkTable;
+	quantizePositions(&(points[0]), numPoints, QUANT_CHUNK_SIZE, q, chunkTable);
+
+	std::vector<QuantInstance> instances(numPoints);
+	for(unsigned int p = 0; p < numPoints; p++){
+		std::copy(q.begin() + QUANT_STRIDE*p, q.begin() + QUANT_STRIDE*(p + 1), instances[p].pos);
+		packColor(p, instances[p].color);
+		instances[p].radius = radii[p];
+	}
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &chunkBuffer);
+	glGenTextures(1, &chunkTexture);
+
+	glBindVertexArray(VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertexData.size()*sizeof(float), &(vertexData[0]), GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, instances.size()*sizeof(QuantInstance), &(instances[0]), GL_STATIC_DRAW);
+
+	// Location 0: Position within the chunk, normalized to [0, 1]
+	glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(QuantInstance), (GLvoid*)offsetof(QuantInstance, pos));
+	glEnableVertexAttribArray(0);
+	glVertexAttribDivisor(0, 1);
+
+	// Location 1: Color, normalized to [0, 1]
+	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(QuantInstance), (GLvoid*)offsetof(QuantInstance, color));
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 1);
+
+	// Location 2: Chunk index (integer)
+	glVertexAttribIPointer(2, 1, GL_UNSIGNED_SHORT, sizeof(QuantInstance), (GLvoid*)(offsetof(QuantInstance, pos) + 3*sizeof(GLushort)));
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, 1);
+
+	// Location 3: Radius
+	glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(QuantInstance), (GLvoid*)offsetof(QuantInstance, radius));
+	glEnableVertexAttribArray(3);
+	glVertexAttribDivisor(3, 1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	glBindBuffer(GL_TEXTURE_BUFFER, chunkBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, chunkTable.size()*sizeof(float), &(chunkTable[0]), GL_STATIC_DRAW);
+	glBindTexture(GL_TEXTURE_BUFFER, chunkTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, chunkBuffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}//====================================================
+
+/**
+ *  @brief Look up the uniform locations of the "billboard" shader
+ *  @details Nothing is done if the locations were already resolved for the
+ *  program currently stored in the shader
+ *  
+ *  @param shader the "billboard" shader
+ */
+void BillboardSet::resolveUniforms(Shader &shader){
+	if(uniforms.program == shader.getID())
+		return;
 
+	uniforms.program = shader.getID();
+	uniforms.bQuantized = shader.getUniformLocation("bQuantized");
+	uniforms.shape = shader.getUniformLocation("shape");
+	uniforms.chunkTable = shader.getUniformLocation("chunkTable");
+	uniforms.bLineNodes = shader.getUniformLocation("bLineNodes");
+	uniforms.lineVertices = shader.getUniformLocation("lineVertices");
+	uniforms.bLineIndexed = shader.getUniformLocation("bLineIndexed");
+	uniforms.nodeFirst = shader.getUniformLocation("nodeFirst");
+	uniforms.nodeStride = shader.getUniformLocation("nodeStride");
+}//====================================================
+
+/**
+ *  @brief Point the instance attributes (locations 0, 1, and 3) at the bound VBO
+ *  @details The VAO and the VBO must be bound
+ * 
+ *  @param base offset of the first instance in the VBO, bytes
+ */
+void BillboardSet::setInstanceAttribs(GLintptr base){
     // Location 0: Position (3-d vector)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 7*sizeof(GL_FLOAT), (GLvoid*)0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (GLvoid*)(base + offsetof(Instance, pos)));
     glEnableVertexAttribArray(0);
+    glVertexAttribDivisor(0, 1);
 
-    // Location 1: Color (4-d vector)
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 7*sizeof(GL_FLOAT), (GLvoid*)(3*sizeof(GLfloat)));
+    // Location 1: Color (4-d vector, normalized)
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance), (GLvoid*)(base + offsetof(Instance, color)));
     glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);   // Note that this is allowed, the call to glVertexAttribPointer registered VBO as the currently bound vertex buffer object so afterwards we can safely unbind
-    glBindVertexArray(0);   // Unbind VAO (it's always a good thing to unbind any buffer/array to prevent strange bugs), remember: do NOT unbind the EBO, keep it bound to this VAO
+    // Location 3: Radius
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Instance), (GLvoid*)(base + offsetof(Instance, radius)));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
 }//====================================================
 
-void BillboardSet::draw(){
-	// GLOBAL_APP->getResMan()->getShader("colored").use();
-	GLOBAL_APP->getResMan()->getShader("billboard").use();
-	
-	glBindVertexArray(VAO);
-	glDrawArrays(GL_POINTS, 0, numPoints);	// Only one point for now
-    glBindVertexArray(0);
+/**
+ *  @brief Write billboards from the CPU copy to one region of a dynamic set
+ * 
+ *  @param r index of the region
+ *  @param first index of the first billboard to write
+ *  @param count number of billboards to write
+ */
+void BillboardSet::writeInstances(unsigned int r, size_t first, size_t count){
+	std::vector<Instance> staging;
+	Instance *pDest = nullptr;
+	if(bPersistent){
+		pDest = pMapped + r*capacity + first;
+	}else{
+		staging.resize(count);
+		pDest = &(staging[0]);
+	}
+
+	for(size_t i = 0; i < count; i++){
+		size_t p = first + i;
+		Instance inst;
+		std::copy(points.begin() + 3*p, points.begin() + 3*p + 3, inst.pos);
+		packColor(p, inst.color);
+		inst.radius = radii[p];
+		pDest[i] = inst;	// One write per instance; the mapping may be write-combined
+	}
+
+	if(!bPersistent){
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferSubData(GL_ARRAY_BUFFER, (r*capacity + first)*sizeof(Instance), count*sizeof(Instance), pDest);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}//====================================================
+
+/**
+ *  @brief Convert the color of a billboard to normalized bytes
+ * 
+ *  @param p index of the billboard
+ *  @param rgba receives four bytes
+ */
+void BillboardSet::packColor(unsigned int p, GLubyte *rgba) const{
+	for(unsigned int k = 0; k < 4; k++){
+		float c = std::min(std::max(colors[4*p + k], 0.f), 1.f);
+		rgba[k] = static_cast<GLubyte>(std::lround(c*255));
+	}
 }//====================================================
 
 } // End of gui namespace
@@ -41,6 +41,16 @@ CameraFPS::CameraFPS(glm::vec3 position, glm::vec3 target, glm::vec3 up){
 //      Set and Get Functions
 //-----------------------------------------------------
 
+/**
+ *  @brief Retrieve the volume visible to the camera
+ * 
+ *  @param projection projection matrix used with the camera's view matrix
+ *  @return the view frustum, world coordinates
+ */
+Frustum CameraFPS::getFrustum(const glm::mat4 &projection) const{
+    return Frustum(projection*getViewMatrix());
+}//====================================================
+
 void CameraFPS::getViewMatrix(glm::mat4 *view) const{
     *view = glm::lookAt(position, target, up);
 }//====================================================
@@ -107,16 +107,9 @@ void DemoWindow::update(){
 
 	camera.processMouseScroll(mouse_scrollYOffset);
 
-	glm::mat4 view = camera.getViewMatrix();
-
-    glm::mat4 projection;
+	// The shaders read view and projection from the Camera uniform block (see Window::render())
+	view = camera.getViewMatrix();
     projection = glm::perspective(camera.getZoom(), (GLfloat)width / (GLfloat)height, 0.1f, 1000.0f);
-    
-    GLOBAL_APP->getResMan()->getShader("cube").setMatrix4("view", view, true);
-    GLOBAL_APP->getResMan()->getShader("cube").setMatrix4("projection", projection);
-
-    GLOBAL_APP->getResMan()->getShader("line_thick").setMatrix4("modelViewProjectionMatrix", projection*view, true);
-    GLOBAL_APP->getResMan()->getShader("line_thick").setVector2f("viewportSize", width, height);
 
     checkForGLErrors("DemoWindow::update()");
 }//====================================================
@@ -157,7 +150,9 @@ void DemoWindow::draw(){
     glDisable(GL_CULL_FACE);
     glActiveTexture(GL_TEXTURE0);
     GLOBAL_APP->getResMan()->getTexture("container").bind();
-    GLOBAL_APP->getResMan()->getShader("cube").setInteger("ourTexture1", 0, true);
+    Shader &cubeShader = GLOBAL_APP->getResMan()->getShader("cube");
+    cubeShader.setInteger("ourTexture1", 0, true);
+    GLint modelLoc = cubeShader.getUniformLocation("model");
 
     glBindVertexArray(VAO);
     for(GLuint i = 0; i < 10; i++){
@@ -169,7 +164,7 @@ void DemoWindow::draw(){
             angle *= glfwGetTime();
 
         model = glm::rotate(model, angle, glm::vec3(1.0f, 0.3f, 0.5f));
-        GLOBAL_APP->getResMan()->getShader("cube").setMatrix4("model", model);
+        cubeShader.setMatrix4(modelLoc, model);
 
         glDrawArrays(GL_TRIANGLES, 0, 36);
     }
@@ -34,15 +34,297 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <list>
+#include <map>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "App.hpp"
+#include "AtlasCache.hpp"
 #include "ResourceManager.hpp"
 
 namespace astrohelion{
 namespace gui{
 
+/** Pixel size at which glyphs are rasterized to compute their distance fields */
+static const int SDF_BASE_SIZE = 48;
+
+/** Distance (in atlas pixels) that maps to the full range of the distance field; also the margin around each glyph */
+static const int SDF_SPREAD = 6;
+
+/** Width and height of each slot in the atlas, pixels; glyph distance fields larger than this are not drawn */
+static const int ATLAS_SLOT_SIZE = SDF_BASE_SIZE + 2*SDF_SPREAD + 20;
+
+/** Code point stored in slots that hold no glyph */
+static const char32_t NO_GLYPH = 0xFFFFFFFF;
+
+/** Number of floats queued for each vertex (x, y, u, v, r, g, b) */
+static const unsigned int TEXT_VERTEX_STRIDE = 7;
+
+Font::FontUniforms Font::uniforms {};
+
+/**
+ *  @brief Glyph metrics stored in the atlas cache (see AtlasCache)
+ *  @details Glyphs are stored from least to most recently used so that
+ *  restoring them in order also restores the LRU order
+ */
+struct CachedGlyph{
+	uint32_t code;			//!< Unicode code point
+	int32_t slot;			//!< Atlas slot that stores the glyph; -1 if the face cannot draw the code point
+	int32_t size[2];		//!< FontChar::size
+	int32_t bearing[2];		//!< FontChar::bearing
+	uint32_t advance;		//!< FontChar::advance
+	uint32_t reserved;		//!< Unused; zero
+};
+
+/** FreeType library shared by every face; released when the last face is */
+static std::weak_ptr<FT_LibraryRec_> sharedLibrary;
+
+/** Faces opened by acquireFace(), by filepath */
+static std::map<std::string, std::weak_ptr<FT_FaceRec_> > sharedFaces;
+
+/**
+ *  @brief Retrieve the FreeType face for a font file, opening it if necessary
+ *  @details Every Font that uses the same file shares one face, and every face
+ *  shares one FreeType library, so FreeType is initialized once per process
+ *  rather than once per Font. The face is sized to SDF_BASE_SIZE.
+ * 
+ *  @param path Filepath to the font TTF file
+ *  @return the face, or nullptr if FreeType or the face could not be loaded
+ */
+static std::shared_ptr<FT_FaceRec_> acquireFace(const std::string &path){
+	std::shared_ptr<FT_FaceRec_> pFace = sharedFaces[path].lock();
+	if(pFace)
+		return pFace;
+
+	std::shared_ptr<FT_LibraryRec_> pLib = sharedLibrary.lock();
+	if(!pLib){
+		FT_Library lib = nullptr;
+		if(FT_Init_FreeType(&lib))
+			return nullptr;
+
+		pLib = std::shared_ptr<FT_LibraryRec_>(lib, FT_Done_FreeType);
+		sharedLibrary = pLib;
+	}
+
+	FT_Face face = nullptr;
+	if(FT_New_Face(pLib.get(), path.c_str(), 0, &face))
+		return nullptr;
+
+	FT_Set_Pixel_Sizes(face, 0, SDF_BASE_SIZE);	// Set width to zero so it is auto-computed
+
+	// The face holds a reference to the library so that the library outlives it
+	pFace = std::shared_ptr<FT_FaceRec_>(face, [pLib](FT_Face f){ FT_Done_Face(f); });
+	sharedFaces[path] = pFace;
+	return pFace;
+}//====================================================
+
+/**
+ *  @brief Compute the squared distance transform of a sampled 1-D function
+ *  @details Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled
+ *  Functions," 2012: <tt>d[q] = min_p (q - p)^2 + f[p]</tt> in linear time
+ * 
+ *  @param f sampled function; zero at features and a large value elsewhere
+ *  @param n number of samples
+ *  @param d receives the transform
+ *  @param v scratch space for n ints
+ *  @param z scratch space for n + 1 floats
+ */
+static void distanceTransform1D(const float *f, int n, float *d, int *v, float *z){
+	const float INF = 1e20f;
+	int k = 0;
+	v[0] = 0;
+	z[0] = -INF;
+	z[1] = INF;
+	for(int q = 1; q < n; q++){
+		float s = ((f[q] + q*q) - (f[v[k]] + v[k]*v[k]))/(2*q - 2*v[k]);
+		while(s <= z[k]){
+			k--;
+			s = ((f[q] + q*q) - (f[v[k]] + v[k]*v[k]))/(2*q - 2*v[k]);
+		}
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = INF;
+	}
+
+	k = 0;
+	for(int q = 0; q < n; q++){
+		while(z[k + 1] < q)
+			k++;
+		d[q] = (q - v[k])*(q - v[k]) + f[v[k]];
+	}
+}//====================================================
+
+/**
+ *  @brief Compute the Euclidean distance from every pixel to the nearest feature pixel
+ * 
+ *  @param grid on input, zero at features and a large value elsewhere; on
+ *  output, the distance (not squared) to the nearest feature
+ *  @param w width of the grid
+ *  @param h height of the grid
+ */
+static void distanceTransform2D(std::vector<float> &grid, int w, int h){
+	int n = std::max(w, h);
+	std::vector<float> f(n), d(n), z(n + 1);
+	std::vector<int> v(n);
+
+	for(int x = 0; x < w; x++){
+		for(int y = 0; y < h; y++){ f[y] = grid[y*w + x]; }
+		distanceTransform1D(&(f[0]), h, &(d[0]), &(v[0]), &(z[0]));
+		for(int y = 0; y < h; y++){ grid[y*w + x] = d[y]; }
+	}
+
+	for(int y = 0; y < h; y++){
+		distanceTransform1D(&(grid[y*w]), w, &(d[0]), &(v[0]), &(z[0]));
+		for(int x = 0; x < w; x++){ grid[y*w + x] = std::sqrt(d[x]); }
+	}
+}//====================================================
+
+/**
+ *  @brief Convert a glyph bitmap to a signed distance field
+ *  @details The field is SDF_SPREAD pixels larger than the bitmap on every
+ *  side. Texels on the outline store 128; the value changes by 127/SDF_SPREAD
+ *  per pixel, increasing toward the inside of the glyph.
+ * 
+ *  @param bmp bitmap rendered by FreeType (one byte per pixel)
+ *  @param sdf receives (width + 2*SDF_SPREAD)*(rows + 2*SDF_SPREAD) bytes
+ */
+static void computeSDF(const FT_Bitmap &bmp, std::vector<unsigned char> &sdf){
+	const float INF = 1e20f;
+	int w = static_cast<int>(bmp.width) + 2*SDF_SPREAD;
+	int h = static_cast<int>(bmp.rows) + 2*SDF_SPREAD;
+
+	// Distance from each outside pixel to the glyph, and from each inside pixel to the background
+	std::vector<float> toInside(w*h, INF), toOutside(w*h, 0);
+	for(unsigned int row = 0; row < bmp.rows; row++){
+		for(unsigned int col = 0; col < bmp.width; col++){
+			if(bmp.buffer[row*bmp.pitch + col] > 127){
+				size_t ix = (row + SDF_SPREAD)*w + col + SDF_SPREAD;
+				toInside[ix] = 0;
+				toOutside[ix] = INF;
+			}
+		}
+	}
+	distanceTransform2D(toInside, w, h);
+	distanceTransform2D(toOutside, w, h);
+
+	sdf.resize(w*h);
+	for(int i = 0; i < w*h; i++){
+		// Pixel centers are half a pixel from the outline on either side
+		float dist = toInside[i] > 0 ? -(toInside[i] - 0.5f) : toOutside[i] - 0.5f;
+		float val = 128.f + dist*127.f/SDF_SPREAD;
+		sdf[i] = static_cast<unsigned char>(std::min(std::max(val, 0.f), 255.f));
+	}
+}//====================================================
+
+/**
+ *  @brief Describe the layout of text vertices to the bound VAO
+ *  @details The VBO that stores the vertices must be bound
+ */
+static void setTextAttribs(){
+	// Location 0: Position and texture coordinates (vec2 pos, vec2 tex)
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, TEXT_VERTEX_STRIDE * sizeof(GLfloat), 0);
+
+	// Location 1: Color (RGB)
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, TEXT_VERTEX_STRIDE * sizeof(GLfloat), (GLvoid*)(4 * sizeof(GLfloat)));
+}//====================================================
+
+/**
+ *  @brief Decode the UTF-8 character that starts at a position in a string
+ *  @details Malformed sequences decode to U+FFFD, the replacement character
+ * 
+ *  @param str UTF-8 string
+ *  @param i index of the first byte of the character; advanced past the character
+ *  @return the code point
+ */
+static char32_t decodeUTF8(const std::string &str, size_t &i){
+	unsigned char c = static_cast<unsigned char>(str[i++]);
+	if(c < 0x80)
+		return c;
+
+	int extra = c >= 0xF0 ? 3 : (c >= 0xE0 ? 2 : (c >= 0xC0 ? 1 : -1));
+	if(extra < 0 || c >= 0xF8)
+		return 0xFFFD;
+
+	char32_t cp = c & (0x3F >> extra);
+	for(int k = 0; k < extra; k++){
+		if(i >= str.size() || (static_cast<unsigned char>(str[i]) & 0xC0) != 0x80)
+			return 0xFFFD;
+		cp = (cp << 6) | (static_cast<unsigned char>(str[i++]) & 0x3F);
+	}
+	return cp;
+}//====================================================
+
+/**
+ *  @brief The FreeType face of a font and the glyphs stored in its atlas
+ *  @details Each slot of the atlas holds at most one glyph. The slots are
+ *  kept in least-recently-used order, with empty slots at the back, so the
+ *  slot at the back of the list is the one (re)filled by the next miss.
+ */
+struct Font::GlyphCache{
+	std::string fontPath {};			//!< Filepath to the font TTF file
+	std::shared_ptr<FT_FaceRec_> pFace = nullptr;	//!< Face the glyphs are rasterized from; opened by the first miss
+	int slotsPerRow = 0;				//!< Number of slots in each row of the atlas
+	int atlasSize = 0;					//!< Width and height of the atlas, pixels
+
+	std::vector<FontChar> slots {};		//!< Glyph stored in each slot
+	std::vector<char32_t> slotCodes {};	//!< Code point stored in each slot; NO_GLYPH if empty
+	std::vector<unsigned long> slotBatches {};	//!< Batch in which each slot was last queued
+	std::vector<unsigned long> slotGenerations {};	//!< Number of times each slot has been filled
+	std::list<int> lru {};				//!< Slots, from most to least recently used
+	std::vector<std::list<int>::iterator> lruPos {};	//!< Position of each slot in lru
+
+	int ascii[128];						//!< Slot of each ASCII glyph; -1 if not in the atlas
+	std::unordered_map<char32_t, int> lookup {};	//!< Slot of each other glyph in the atlas
+	std::unordered_set<char32_t> missing {};		//!< Code points that cannot be drawn; drawn as '?'
+
+	unsigned long batchID = 1;			//!< Identifies the batch that has not been flushed yet
+	GlyphCacheStats stats {};			//!< Counters since the last reset
+
+	/**
+	 *  @brief Record that a slot now stores a glyph and make it the most recently used
+	 *  @details The slot must not store another glyph
+	 * 
+	 *  @param slot atlas slot
+	 *  @param fchar glyph metrics; the texture coordinates are computed from the slot
+	 *  @param code Unicode code point
+	 */
+	void assign(int slot, FontChar fchar, char32_t code){
+		glm::ivec2 origin = getSlotOrigin(slot);
+		fchar.uvMin = glm::vec2(origin)/static_cast<float>(atlasSize);
+		fchar.uvMax = glm::vec2(origin + fchar.size)/static_cast<float>(atlasSize);
+		slots[slot] = fchar;
+
+		slotCodes[slot] = code;
+		slotGenerations[slot]++;
+		if(code < 128)
+			ascii[code] = slot;
+		else
+			lookup[code] = slot;
+
+		// The new glyph is the most recently used so that the next load fills a different slot
+		lru.splice(lru.begin(), lru, lruPos[slot]);
+	}
+
+	/**
+	 *  @brief Retrieve the position of a slot in the atlas
+	 *  @param slot atlas slot
+	 *  @return the top-left corner of the slot, pixels
+	 */
+	glm::ivec2 getSlotOrigin(int slot) const{
+		return glm::ivec2(ATLAS_SLOT_SIZE*(slot % slotsPerRow), ATLAS_SLOT_SIZE*(slot / slotsPerRow));
+	}
+};
+
 //-----------------------------------------------------
 //      *structors
 //-----------------------------------------------------
@@ -83,14 +365,12 @@ void Font::init(){
 
 	initProjection();
 
-	// Configure VAO/VBO for texture quads
+	// Configure VAO/VBO for texture quads; the VBO is sized by flush()
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
+    setTextAttribs();
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 }//====================================================
@@ -114,6 +394,37 @@ const Font& Font::operator =(const Font &fm){
 //      Set and Get Functions
 //-----------------------------------------------------
 
+/**
+ *  @brief Retrieve the glyph atlas counters
+ *  @return the counters since initFont() or the last call to resetGlyphStats()
+ */
+GlyphCacheStats Font::getGlyphStats() const{
+	if(!pGlyphs)
+		return GlyphCacheStats();
+
+	GlyphCacheStats stats = pGlyphs->stats;
+	stats.numResident = std::count_if(pGlyphs->slotCodes.begin(), pGlyphs->slotCodes.end(),
+		[](char32_t c){ return c != NO_GLYPH; });
+	return stats;
+}//====================================================
+
+/**
+ *  @brief Retrieve the number of glyphs queued since the last flush()
+ *  @return the number of glyphs queued since the last flush()
+ */
+size_t Font::getNumQueuedGlyphs() const { return batch.size()/(6*TEXT_VERTEX_STRIDE); }
+
+/**
+ *  @brief Reset the hit, miss, and eviction counters to zero
+ */
+void Font::resetGlyphStats(){
+	if(pGlyphs){
+		pGlyphs->stats.hits = 0;
+		pGlyphs->stats.misses = 0;
+		pGlyphs->stats.evictions = 0;
+	}
+}//====================================================
+
 /**
  *  @brief Update the size of the viewport
  *  @details If the constructor is used that accepts a GLFW window
@@ -146,77 +457,222 @@ void Font::initProjection(){
 
 /**
  *  @brief Initialize the font
- *  @details [long description]
+ *  @details The atlas is divided into square slots, each of which holds the
+ *  signed distance field of one glyph rasterized at SDF_BASE_SIZE pixels. The
+ *  printable ASCII glyphs are loaded immediately; all others are loaded when
+ *  first drawn. The atlas does not depend on <tt>size</tt>, which only sets
+ *  the size of text drawn at a scale of one.
+ *  
+ *  The preloaded atlas is cached next to the font file (see AtlasCache) and
+ *  keyed by the hash of the font file and the atlas parameters. When a valid
+ *  cache exists, it is uploaded from the mapped file and the FreeType face is
+ *  not opened until a glyph that is not in the atlas is drawn.
  * 
  *  @param fontPath Filepath to the font TTF file
- *  @param size Size of the font, pixels (I think?)
+ *  @param size Size of the font at a scale of one, pixels
+ *  @param atlasSize width and height of the atlas, pixels; see getGlyphStats()
+ *  to determine whether the atlas is large enough for the text drawn
+ *  @throws std::runtime_error if the font cannot be loaded or the atlas cannot hold a glyph
  */
-void Font::initFont(const char* fontPath, float size){
-	// All functions return 0 if the succeed, something else otherwise
-	FT_Library library;
-	if(FT_Init_FreeType(&library))
-		throw std::runtime_error("Font: Could not init FreeType Library");
+void Font::initFont(const char* fontPath, float size, int atlasSize){
+	if(atlasSize < ATLAS_SLOT_SIZE)
+		throw std::runtime_error("Font::initFont: Atlas is too small to store a glyph");
 
-	// Load font as face
-	FT_Face face;
-	if(FT_New_Face(library, fontPath, 0, &face))
+	// The atlas depends on the font file and on how glyphs are rasterized and packed, but not on size
+	uint64_t key = 0;
+	if(!AtlasCache::hashFile(fontPath, &key))
 		throw std::runtime_error("Font::initFont: Failed to load FreeType font");
+	const int32_t params[] = {SDF_BASE_SIZE, SDF_SPREAD, ATLAS_SLOT_SIZE, atlasSize};
+	key = AtlasCache::hashBytes(params, sizeof(params), key);
 
-	// Set size to load glyphs as
-	FT_Set_Pixel_Sizes(face, 0, size);	// Set width to zero so it is auto-computed
+	flush();
+	std::shared_ptr<GlyphCache> pCache = std::make_shared<GlyphCache>();
+	pCache->fontPath = fontPath;
+	glyphScale = size/SDF_BASE_SIZE;
 
-	// Disable byte-alignment restriction (allow storing in one color value)
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	pCache->atlasSize = atlasSize;
+	pCache->slotsPerRow = atlasSize/ATLAS_SLOT_SIZE;
+	size_t numSlots = pCache->slotsPerRow*pCache->slotsPerRow;
+	pCache->slots.assign(numSlots, FontChar());
+	pCache->slotCodes.assign(numSlots, NO_GLYPH);
+	pCache->slotBatches.assign(numSlots, 0);
+	pCache->slotGenerations.assign(numSlots, 0);
+	pCache->lruPos.resize(numSlots);
+	for(size_t i = 0; i < numSlots; i++){
+		pCache->lruPos[i] = pCache->lru.insert(pCache->lru.end(), static_cast<int>(i));
+	}
+	std::fill(pCache->ascii, pCache->ascii + 128, -1);
+	pCache->stats.numSlots = numSlots;
 
-	// Load first 128 characters of ASCII set
-	for(GLubyte c = 0; c < 128; c++){
-		// Load character glyph
-		if(FT_Load_Char(face, c, FT_LOAD_RENDER)){
-			std::cout << "ERROR::FREETYPE: Failed to load glyph, ascii code " << c << std::endl;
-			continue;
-		}
+	// A cached atlas is uploaded straight from the mapped file and FreeType is not loaded
+	std::string cachePath = AtlasCache::getCachePath(fontPath, SDF_BASE_SIZE);
+	AtlasCache cache;
+	bool bCached = cache.open(cachePath.c_str(), key, SDF_BASE_SIZE) && cache.getWidth() == atlasSize &&
+		cache.getHeight() == atlasSize && cache.getBytesPerPixel() == 1 &&
+		cache.getMetricsSize() % sizeof(CachedGlyph) == 0;
 
-		// Generate texture
-		FontChar fchar;
-		glGenTextures(1, &(fchar.texID));
-		glBindTexture(GL_TEXTURE_2D, fchar.texID);
-		glTexImage2D(
-			GL_TEXTURE_2D,
-			0,
-			GL_RED,
-			face->glyph->bitmap.width,
-			face->glyph->bitmap.rows,
-			0,
-			GL_RED,
-			GL_UNSIGNED_BYTE,
-			face->glyph->bitmap.buffer
-		); // single byte of data (8 bits) is stored in RED component of color
-
-		// Set texture options
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// Store character for later use
-		fchar.size = glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows);
-		fchar.bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
-		fchar.advance = static_cast<GLuint>(face->glyph->advance.x);
-		// FontChar fchar = {
-		// 	texture,
-		// 	glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-		// 	glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-		// 	static_cast<GLuint>(face->glyph->advance.x)
-		// };
-
-		characters.insert(std::pair<GLchar, FontChar>(c, fchar));
+	if(!bCached){
+		pCache->pFace = acquireFace(fontPath);
+		if(!pCache->pFace)
+			throw std::runtime_error("Font::initFont: Failed to load FreeType font");
 	}
 
+	if(atlasTex == 0)
+		glGenTextures(1, &atlasTex);
+	glBindTexture(GL_TEXTURE_2D, atlasTex);
+	std::vector<unsigned char> blank(bCached ? 0 : atlasSize*atlasSize, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);	// Disable byte-alignment restriction (allow storing in one color value)
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasSize, atlasSize, 0, GL_RED, GL_UNSIGNED_BYTE,
+		bCached ? cache.getTexels() : &(blank[0]));
+	// single byte of data (8 bits) is stored in RED component of color
+
+	// Set texture options
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glBindTexture(GL_TEXTURE_2D, 0);	// Unset the texture
 
-	// Destroy face once we're finished
-	FT_Done_Face(face);
-	FT_Done_FreeType(library);
+	pGlyphs = pCache;
+
+	if(bCached){
+		const CachedGlyph *pGlyph = static_cast<const CachedGlyph*>(cache.getMetrics());
+		size_t numGlyphs = cache.getMetricsSize()/sizeof(CachedGlyph);
+		for(size_t i = 0; i < numGlyphs; i++, pGlyph++){
+			if(pGlyph->slot < 0){
+				pCache->missing.insert(pGlyph->code);
+			}else if(static_cast<size_t>(pGlyph->slot) < numSlots){
+				FontChar fchar;
+				fchar.size = glm::ivec2(pGlyph->size[0], pGlyph->size[1]);
+				fchar.bearing = glm::ivec2(pGlyph->bearing[0], pGlyph->bearing[1]);
+				fchar.advance = pGlyph->advance;
+				pCache->assign(pGlyph->slot, fchar, pGlyph->code);
+			}
+		}
+		return;
+	}
+
+	// Printable ASCII is used by nearly all text; preloading it does not count as misses
+	for(char32_t c = 32; c < 127 && c - 32 < numSlots; c++){
+		loadGlyph(c);
+	}
+
+	writeAtlasCache(cachePath.c_str(), key);
+}//====================================================
+
+/**
+ *  @brief Write the atlas and the metrics of the glyphs it stores to a cache file
+ *  @details The next initFont() call for the same font file and atlas size maps
+ *  the cache instead of rasterizing the glyphs. Failure to write the cache is
+ *  reported but is not an error.
+ * 
+ *  @param cachePath filepath to the cache file
+ *  @param key hash of the font file and the atlas parameters
+ */
+void Font::writeAtlasCache(const char* cachePath, uint64_t key) const{
+	const GlyphCache &gc = *pGlyphs;
+
+	std::vector<CachedGlyph> glyphs;
+	for(char32_t code : gc.missing){
+		CachedGlyph g {};
+		g.code = code;
+		g.slot = -1;
+		glyphs.push_back(g);
+	}
+	for(std::list<int>::const_reverse_iterator it = gc.lru.rbegin(); it != gc.lru.rend(); ++it){
+		if(gc.slotCodes[*it] == NO_GLYPH)
+			continue;
+
+		const FontChar &fchar = gc.slots[*it];
+		CachedGlyph g {};
+		g.code = gc.slotCodes[*it];
+		g.slot = *it;
+		g.size[0] = fchar.size.x;
+		g.size[1] = fchar.size.y;
+		g.bearing[0] = fchar.bearing.x;
+		g.bearing[1] = fchar.bearing.y;
+		g.advance = fchar.advance;
+		glyphs.push_back(g);
+	}
+
+	std::vector<unsigned char> texels(gc.atlasSize*gc.atlasSize);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glBindTexture(GL_TEXTURE_2D, atlasTex);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_UNSIGNED_BYTE, &(texels[0]));
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	try{
+		AtlasCache::write(cachePath, key, SDF_BASE_SIZE, gc.atlasSize, gc.atlasSize, 1, &(texels[0]),
+			glyphs.empty() ? nullptr : &(glyphs[0]), glyphs.size()*sizeof(CachedGlyph));
+	}catch(std::exception &e){
+		std::cout << "Font::initFont: Could not write atlas cache: " << e.what() << std::endl;
+	}
+}//====================================================
+
+/**
+ *  @brief Add text to the batch drawn by the next flush()
+ *  @details Glyphs that are not in the atlas are loaded, which may flush the
+ *  text queued so far if the atlas is full. Characters that the face cannot
+ *  draw are drawn as '?'. The text is sharp at any scale because it is
+ *  reconstructed from the distance fields.
+ * 
+ *  @param str Text to render
+ *  @param x bottom-left corner of the text, pixels, screen coord
+ *  @param y bottom-left corner of the text, pixels, screen coord
+ *  @param scale scaling factor for the font
+ *  @param color RGB normalized color vector (values 0 - 1)
+ */
+void Font::queueText(const std::string &str, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color){
+	if(!pGlyphs)
+		return;
+
+	layoutText(str, x, y, scale, color, batch, nullptr);
+}//====================================================
+
+/**
+ *  @brief Draw all queued text with a single draw call and clear the queue
+ *  @details The VBO is enlarged if necessary, and otherwise orphaned before
+ *  it is refilled so that the upload does not wait on the previous draw.
+ */
+void Font::flush(){
+	if(batch.empty())
+		return;
+
+	// Set OpenGL options
+	GLboolean bBlendWasEnabled = glIsEnabled(GL_BLEND);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Activate the corresponding render state
+	if(GLOBAL_APP->getResMan()){
+		Shader &shader = GLOBAL_APP->getResMan()->getShader("font");
+		resolveUniforms(shader);
+		shader.setInteger(uniforms.text, 0, true);
+		shader.setVector2f(uniforms.offset, 0, 0);
+	}
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, atlasTex);
+
+	// Update content of VBO memory
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	if(batch.size() > vboCapacity)
+		vboCapacity = std::max(batch.size(), 2*vboCapacity);
+	glBufferData(GL_ARRAY_BUFFER, vboCapacity*sizeof(GLfloat), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, batch.size()*sizeof(GLfloat), &(batch[0]));
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// Render every quad
+	glBindVertexArray(VAO);
+	glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(batch.size()/TEXT_VERTEX_STRIDE));
+	glBindVertexArray(0);				// Unset VAO
+	glBindTexture(GL_TEXTURE_2D, 0);	// Unset texture
+
+	if(!bBlendWasEnabled)
+		glDisable(GL_BLEND);
+
+	batch.clear();
+	if(pGlyphs)
+		pGlyphs->batchID++;	// Glyphs in the atlas may now be evicted
 }//====================================================
 
 /**
@@ -227,14 +683,15 @@ void Font::initFont(const char* fontPath, float size){
  *  @param x bottom-left corner of the text, pixels, screen coord
  *  @param y bottom-left corner of the text, pixels, screen coord
  */
-void Font::renderText(std::string str, GLfloat x, GLfloat y){
+void Font::renderText(const std::string &str, GLfloat x, GLfloat y){
 	// Default to scale = 1 and color = black
 	renderText(str, x, y, 1.0f, glm::fvec3(0.0, 0.0, 0.0));
 }//====================================================
 
 /**
  *  @brief Render some text on screen
- *  @details [long description]
+ *  @details The text is drawn immediately, along with any text queued by
+ *  queueText(). To draw many strings, queue them and call flush() once.
  * 
  *  @param str Text to render
  *  @param x bottom-left corner of the text, pixels, screen coord
@@ -242,24 +699,231 @@ void Font::renderText(std::string str, GLfloat x, GLfloat y){
  *  @param scale scaling factor for the font
  *  @param color RGB normalized color vector (values 0 - 1)
  */
-void Font::renderText(std::string str, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color){
-	// Set OpenGL options
-	// TODO: Detect old values and rest after rendering text??
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+void Font::renderText(const std::string &str, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color){
+	queueText(str, x, y, scale, color);
+	flush();
+}//====================================================
+
+/**
+ *  @brief Lay out text once for repeated drawing
+ *  @details The quads are stored in a vertex buffer owned by the font, so
+ *  drawing the text costs one draw call and no layout. Release the handle
+ *  with destroyText().
+ * 
+ *  @param str Text (UTF-8)
+ *  @param scale scaling factor for the font
+ *  @param color RGB normalized color vector (values 0 - 1)
+ *  @return a handle for drawText(), updateText(), and destroyText()
+ */
+int Font::createText(const std::string &str, GLfloat scale, glm::vec3 color){
+	TextRun run;
+	run.str = str;
+	run.scale = scale;
+	run.color = color;
+	return createText(std::vector<TextRun>(1, run));
+}//====================================================
+
+/**
+ *  @brief Lay out several strings once for repeated drawing
+ *  @details All of the strings are stored in one vertex buffer, so drawing
+ *  them costs one draw call and no layout. Release the handle with
+ *  destroyText().
+ * 
+ *  @param runs strings and their positions relative to the position passed
+ *  to drawText()
+ *  @return a handle for drawText(), updateText(), and destroyText()
+ */
+int Font::createText(const std::vector<TextRun> &runs){
+	size_t h = 0;
+	while(h < texts.size() && texts[h].bActive){ h++; }
+	if(h == texts.size())
+		texts.push_back(RetainedText());
+
+	RetainedText &text = texts[h];
+	text.runs = runs;
+	text.bActive = true;
+	layoutRetained(text);
+	return static_cast<int>(h);
+}//====================================================
+
+/**
+ *  @brief Release retained text
+ *  @details The handle may be returned again by a later call to createText()
+ *  @param handle handle returned by createText()
+ *  @throws std::out_of_range if the handle is not valid
+ */
+void Font::destroyText(int handle){
+	if(handle < 0 || static_cast<size_t>(handle) >= texts.size() || !texts[handle].bActive)
+		throw std::out_of_range("Font::destroyText: Invalid text handle");
+
+	RetainedText &text = texts[handle];
+	glDeleteVertexArrays(1, &(text.VAO));
+	glDeleteBuffers(1, &(text.VBO));
+	text = RetainedText();
+}//====================================================
+
+/**
+ *  @brief Draw retained text
+ *  @details The text is laid out again only if one of its glyphs has been
+ *  evicted from the atlas since it was laid out. Its glyphs are marked as
+ *  recently used so that text drawn every frame keeps its glyphs resident.
+ *  The quads are in pixels and the viewport only changes the projection (see
+ *  updateWindow()), so resizing the window does not require a new layout.
+ * 
+ *  @param handle handle returned by createText()
+ *  @param x bottom-left corner of the text, pixels, screen coord
+ *  @param y bottom-left corner of the text, pixels, screen coord
+ *  @throws std::out_of_range if the handle is not valid
+ */
+void Font::drawText(int handle, GLfloat x, GLfloat y){
+	if(handle < 0 || static_cast<size_t>(handle) >= texts.size() || !texts[handle].bActive)
+		throw std::out_of_range("Font::drawText: Invalid text handle");
+
+	RetainedText &text = texts[handle];
+	if(pGlyphs){
+		GlyphCache &gc = *pGlyphs;
+		bool bStale = false;
+		for(const std::pair<int, unsigned long> &g : text.glyphs){
+			if(gc.slotGenerations[g.first] != g.second){
+				bStale = true;
+				break;
+			}
+			gc.lru.splice(gc.lru.begin(), gc.lru, gc.lruPos[g.first]);
+		}
+
+		if(bStale)
+			layoutRetained(text);
+	}
+
+	if(text.numVerts == 0)
+		return;
+
+	GLboolean bBlendWasEnabled = glIsEnabled(GL_BLEND);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	// Activate the corresponding render state
 	if(GLOBAL_APP->getResMan()){
-		GLOBAL_APP->getResMan()->getShader("font").setVector3f("textColor", color.x, color.y, color.z, true);
+		Shader &shader = GLOBAL_APP->getResMan()->getShader("font");
+		resolveUniforms(shader);
+		shader.setInteger(uniforms.text, 0, true);
+		shader.setVector2f(uniforms.offset, x, y);
 	}
 	glActiveTexture(GL_TEXTURE0);
-	glBindVertexArray(VAO);
+	glBindTexture(GL_TEXTURE_2D, atlasTex);
+
+	glBindVertexArray(text.VAO);
+	glDrawArrays(GL_TRIANGLES, 0, text.numVerts);
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	if(!bBlendWasEnabled)
+		glDisable(GL_BLEND);
+}//====================================================
+
+/**
+ *  @brief Change retained text
+ *  @details The text is laid out again only if the string, scale, or color
+ *  has changed, so this may be called every frame
+ * 
+ *  @param handle handle returned by createText()
+ *  @param str Text (UTF-8)
+ *  @param scale scaling factor for the font
+ *  @param color RGB normalized color vector (values 0 - 1)
+ *  @throws std::out_of_range if the handle is not valid
+ */
+void Font::updateText(int handle, const std::string &str, GLfloat scale, glm::vec3 color){
+	if(handle < 0 || static_cast<size_t>(handle) >= texts.size() || !texts[handle].bActive)
+		throw std::out_of_range("Font::updateText: Invalid text handle");
+
+	RetainedText &text = texts[handle];
+	if(text.runs.size() == 1 && text.runs[0].str == str && text.runs[0].scale == scale &&
+		text.runs[0].color == color && text.runs[0].origin == glm::vec2(0, 0)){
+		return;
+	}
+
+	TextRun run;
+	run.str = str;
+	run.scale = scale;
+	run.color = color;
+	text.runs.assign(1, run);
+	layoutRetained(text);
+}//====================================================
+
+/**
+ *  @brief Replace the strings of retained text
+ *  @details The text is always laid out again, so call this only when the
+ *  strings or their positions change
+ * 
+ *  @param handle handle returned by createText()
+ *  @param runs strings and their positions relative to the position passed
+ *  to drawText()
+ *  @throws std::out_of_range if the handle is not valid
+ */
+void Font::updateText(int handle, const std::vector<TextRun> &runs){
+	if(handle < 0 || static_cast<size_t>(handle) >= texts.size() || !texts[handle].bActive)
+		throw std::out_of_range("Font::updateText: Invalid text handle");
 
-	// Iteration through all characters
-	std::string::const_iterator c;
-	for(c = str.begin(); c != str.end(); c++){
-		FontChar ch = characters[*c];
+	RetainedText &text = texts[handle];
+	text.runs = runs;
+	layoutRetained(text);
+}//====================================================
+
+/**
+ *  @brief Compute the bounding box of a string
+ *  @details The box covers the ink of the glyphs (the distance field margin
+ *  is excluded) and the advance of the last glyph. Glyphs that are not in the
+ *  atlas are loaded.
+ * 
+ *  @param str Text (UTF-8)
+ *  @param scale scaling factor for the font
+ *  @param pMin receives the bottom-left corner of the box relative to the
+ *  origin passed to queueText() or drawText(), pixels
+ *  @param pMax receives the top-right corner of the box, pixels
+ */
+void Font::measureText(const std::string &str, GLfloat scale, glm::vec2 *pMin, glm::vec2 *pMax){
+	*pMin = glm::vec2(0, 0);
+	*pMax = glm::vec2(0, 0);
+	if(!pGlyphs)
+		return;
+
+	scale *= glyphScale;
+	GLfloat x = 0;
+	for(size_t i = 0; i < str.size(); ){
+		const FontChar &ch = getGlyph(decodeUTF8(str, i));
+		if(ch.size.x > 2*SDF_SPREAD && ch.size.y > 2*SDF_SPREAD){
+			glm::vec2 lo(x + (ch.bearing.x + SDF_SPREAD)*scale, (ch.bearing.y - ch.size.y + SDF_SPREAD)*scale);
+			glm::vec2 hi = lo + glm::vec2(ch.size - 2*SDF_SPREAD)*scale;
+			*pMin = glm::min(*pMin, lo);
+			*pMax = glm::max(*pMax, hi);
+		}
+		x += (ch.advance >> 6) * scale;
+	}
+	pMax->x = std::max(pMax->x, x);
+}//====================================================
+
+/**
+ *  @brief Append the quads for a string to a vertex array
+ *  @details Glyphs that are not in the atlas are loaded, which may flush the
+ *  queued text if the atlas is full
+ * 
+ *  @param str Text to lay out (UTF-8)
+ *  @param x bottom-left corner of the text, pixels, screen coord
+ *  @param y bottom-left corner of the text, pixels, screen coord
+ *  @param scale scaling factor for the font
+ *  @param color RGB normalized color vector (values 0 - 1)
+ *  @param verts receives six vertices per visible glyph; see TEXT_VERTEX_STRIDE
+ *  @param pGlyphRefs if not null, receives the atlas slot of each glyph and
+ *  the generation of that slot
+ */
+void Font::layoutText(const std::string &str, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color,
+	std::vector<GLfloat> &verts, std::vector<std::pair<int, unsigned long> > *pGlyphRefs){
+	verts.reserve(verts.size() + 6*TEXT_VERTEX_STRIDE*str.size());
+	scale *= glyphScale;	// Atlas pixels to screen pixels
+	for(size_t i = 0; i < str.size(); ){
+		int slot = -1;
+		const FontChar &ch = getGlyph(decodeUTF8(str, i), &slot);
+		if(pGlyphRefs && slot >= 0)
+			pGlyphRefs->push_back(std::make_pair(slot, pGlyphs->slotGenerations[slot]));
 
 		GLfloat xpos = x + ch.bearing.x * scale;
 		GLfloat ypos = y - (ch.size.y - ch.bearing.y) * scale;
@@ -267,35 +931,185 @@ void Font::renderText(std::string str, GLfloat x, GLfloat y, GLfloat scale, glm:
 		GLfloat w = ch.size.x * scale;
 		GLfloat h = ch.size.y * scale;
 
-		// Update VBO for each character
-		GLfloat verts[6][4] = {
-			{ xpos, 	ypos + h, 	0.0, 0.0 },
-			{ xpos, 	ypos, 		0.0, 1.0 },
-			{ xpos + w, ypos, 		1.0, 1.0 },
+		// Two triangles per glyph; the top of the glyph is at uvMin.y
+		if(w > 0 && h > 0){
+			const GLfloat quad[6][4] = {
+				{ xpos, 	ypos + h, 	ch.uvMin.x, ch.uvMin.y },
+				{ xpos, 	ypos, 		ch.uvMin.x, ch.uvMax.y },
+				{ xpos + w, ypos, 		ch.uvMax.x, ch.uvMax.y },
+
+				{ xpos, 	ypos + h, 	ch.uvMin.x, ch.uvMin.y },
+				{ xpos + w, ypos, 		ch.uvMax.x, ch.uvMax.y },
+				{ xpos + w, ypos + h, 	ch.uvMax.x, ch.uvMin.y }
+			};
 
-			{ xpos, 	ypos + h, 	0.0, 0.0 },
-			{ xpos + w, ypos, 		1.0, 1.0 },
-			{ xpos + w, ypos + h, 	1.0, 0.0 }
-		};
+			for(const GLfloat *v : quad){
+				verts.insert(verts.end(), v, v + 4);
+				verts.insert(verts.end(), {color.x, color.y, color.z});
+			}
+		}
 
-		// Render glyph texture over quad
-		glBindTexture(GL_TEXTURE_2D, ch.texID);
+		// Now advance cursors for next glyph (note that advance is number of 1/64 pixels)
+		x += (ch.advance >> 6) * scale;	// Bitshift by 6 to get value in pixels (2^6 = 64; divide amount of 1/64th pixels to get number of pixels)
+	}
+}//====================================================
 
-		// Update content of VBO memory
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(verts), verts);	// Be sure to use glBufferSubData and not glBufferData
+/**
+ *  @brief Lay out retained text and upload its quads
+ *  @details The quads are relative to the origin of the text; drawText()
+ *  supplies the position as a uniform
+ * 
+ *  @param text retained text
+ */
+void Font::layoutRetained(RetainedText &text){
+	std::vector<GLfloat> verts;
+	text.glyphs.clear();
+	if(pGlyphs){
+		for(const TextRun &run : text.runs){
+			layoutText(run.str, run.origin.x, run.origin.y, run.scale, run.color, verts, &(text.glyphs));
+		}
+	}
 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	if(text.VAO == 0){
+		glGenVertexArrays(1, &(text.VAO));
+		glGenBuffers(1, &(text.VBO));
+		glBindVertexArray(text.VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, text.VBO);
+		setTextAttribs();
+		glBindVertexArray(0);
+	}
 
-		// Render quad
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+	glBindBuffer(GL_ARRAY_BUFFER, text.VBO);
+	glBufferData(GL_ARRAY_BUFFER, verts.size()*sizeof(GLfloat), verts.empty() ? NULL : &(verts[0]), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	text.numVerts = static_cast<GLsizei>(verts.size()/TEXT_VERTEX_STRIDE);
+}//====================================================
 
-		// Now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-		x += (ch.advance >> 6) * scale;	// Bitshift by 6 to get value in pixels (2^6 = 64; divide amount of 1/64th pixels to get number of pixels)
+/**
+ *  @brief Retrieve a glyph, loading it into the atlas if necessary
+ *  @details The glyph becomes the most recently used. Code points that the
+ *  face cannot draw are replaced by '?'.
+ * 
+ *  @param code Unicode code point
+ *  @param pSlot if not null, receives the slot that stores the glyph
+ *  @return the glyph; glyphs with zero size are not drawn
+ */
+const FontChar& Font::getGlyph(char32_t code, int *pSlot){
+	static const FontChar empty;
+	GlyphCache &gc = *pGlyphs;
+
+	int slot = -1;
+	if(code < 128){
+		slot = gc.ascii[code];
+	}else{
+		std::unordered_map<char32_t, int>::const_iterator it = gc.lookup.find(code);
+		if(it != gc.lookup.end())
+			slot = it->second;
 	}
 
-	glBindVertexArray(0);				// Unset VAO
-	glBindTexture(GL_TEXTURE_2D, 0);	// Unset texture
+	if(slot >= 0){
+		gc.stats.hits++;
+	}else if(gc.missing.count(code)){
+		return code == '?' ? empty : getGlyph('?', pSlot);
+	}else{
+		gc.stats.misses++;
+		slot = loadGlyph(code);
+		if(slot < 0)
+			return code == '?' ? empty : getGlyph('?', pSlot);
+	}
+
+	gc.lru.splice(gc.lru.begin(), gc.lru, gc.lruPos[slot]);
+	gc.slotBatches[slot] = gc.batchID;
+	if(pSlot)
+		*pSlot = slot;
+	return gc.slots[slot];
+}//====================================================
+
+/**
+ *  @brief Rasterize a glyph into the least recently used slot of the atlas
+ *  @details If that slot is used by text that has not been drawn yet, the
+ *  queued text is flushed first so that it is drawn with the old glyph.
+ * 
+ *  @param code Unicode code point
+ *  @return the slot that stores the glyph, or -1 if the face cannot draw the
+ *  code point (it is then recorded as missing)
+ */
+int Font::loadGlyph(char32_t code){
+	GlyphCache &gc = *pGlyphs;
+
+	// The face is not opened when the atlas is restored from the cache
+	if(!gc.pFace)
+		gc.pFace = acquireFace(gc.fontPath);
+
+	FT_Face face = gc.pFace.get();
+	FT_UInt glyphIx = face ? FT_Get_Char_Index(face, code) : 0;
+	if(glyphIx == 0 || FT_Load_Glyph(face, glyphIx, FT_LOAD_RENDER)){
+		gc.missing.insert(code);
+		return -1;
+	}
+
+	const FT_Bitmap &bmp = face->glyph->bitmap;
+	std::vector<unsigned char> sdf;
+	int w = 0, h = 0;
+	if(bmp.width > 0 && bmp.rows > 0){
+		computeSDF(bmp, sdf);
+		w = static_cast<int>(bmp.width) + 2*SDF_SPREAD;
+		h = static_cast<int>(bmp.rows) + 2*SDF_SPREAD;
+	}
+	if(w > ATLAS_SLOT_SIZE || h > ATLAS_SLOT_SIZE){
+		std::cout << "ERROR::FREETYPE: Glyph is larger than an atlas slot, code point " << code << std::endl;
+		gc.missing.insert(code);
+		return -1;
+	}
+
+	int slot = gc.lru.back();
+	char32_t oldCode = gc.slotCodes[slot];
+	if(oldCode != NO_GLYPH){
+		if(gc.slotBatches[slot] == gc.batchID)
+			flush();
+
+		if(oldCode < 128)
+			gc.ascii[oldCode] = -1;
+		else
+			gc.lookup.erase(oldCode);
+		gc.stats.evictions++;
+	}
+
+	// The whole slot is written so that no part of the old glyph remains
+	glm::ivec2 origin = gc.getSlotOrigin(slot);
+	std::vector<unsigned char> texels(ATLAS_SLOT_SIZE*ATLAS_SLOT_SIZE, 0);
+	for(int row = 0; row < h; row++){
+		std::copy(sdf.begin() + row*w, sdf.begin() + (row + 1)*w, texels.begin() + row*ATLAS_SLOT_SIZE);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glBindTexture(GL_TEXTURE_2D, atlasTex);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, origin.x, origin.y, ATLAS_SLOT_SIZE, ATLAS_SLOT_SIZE, GL_RED,
+		GL_UNSIGNED_BYTE, &(texels[0]));
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	FontChar fchar;
+	fchar.size = glm::ivec2(w, h);
+	fchar.bearing = glm::ivec2(face->glyph->bitmap_left - SDF_SPREAD, face->glyph->bitmap_top + SDF_SPREAD);
+	fchar.advance = static_cast<GLuint>(face->glyph->advance.x);
+	gc.assign(slot, fchar, code);
+	return slot;
+}//====================================================
+
+/**
+ *  @brief Look up the uniform locations of the "font" shader
+ *  @details Nothing is done if the locations were already resolved for the
+ *  program currently stored in the shader
+ * 
+ *  @param shader the "font" shader
+ */
+void Font::resolveUniforms(Shader &shader){
+	if(uniforms.program == shader.getID())
+		return;
+
+	uniforms.program = shader.getID();
+	uniforms.text = shader.getUniformLocation("text");
+	uniforms.offset = shader.getUniformLocation("offset");
 }//====================================================
 
 /**
@@ -305,9 +1119,13 @@ void Font::renderText(std::string str, GLfloat x, GLfloat y, GLfloat scale, glm:
 void Font::copyMe(const Font &fm){
 	VAO = fm.VAO;
 	VBO = fm.VBO;
+	atlasTex = fm.atlasTex;
+	glyphScale = fm.glyphScale;
+	pGlyphs = fm.pGlyphs;
+	texts = fm.texts;
+	vboCapacity = fm.vboCapacity;
 	viewW = fm.viewW;
 	viewH = fm.viewH;
-	characters = fm.characters;
 }//====================================================
 
 }// End of gui namespace
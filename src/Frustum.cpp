@@ -0,0 +1,114 @@
+/**
+ *  @file Frustum.cpp
+ *	@brief A view frustum used to cull geometry on the CPU
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+
+/*
+ *	Astrohelion
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Frustum.hpp"
+
+namespace astrohelion{
+namespace gui{
+
+//-----------------------------------------------------
+//      *structors
+//-----------------------------------------------------
+
+/**
+ *  @brief Construct a frustum that contains everything
+ */
+Frustum::Frustum(){
+	for(int i = 0; i < 6; i++){
+		planes[i] = glm::vec4(0, 0, 0, 1);
+	}
+}//====================================================
+
+/**
+ *  @brief Construct the frustum of a view-projection matrix
+ *  @details The planes are extracted directly from the rows of the matrix
+ *  (Gribb and Hartmann), so the frustum is expressed in the coordinates the
+ *  matrix transforms from, e.g., world coordinates for projection*view
+ * 
+ *  @param viewProj view-projection matrix
+ */
+Frustum::Frustum(const glm::mat4 &viewProj){
+	// glm matrices are column-major; row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+	glm::vec4 rows[4];
+	for(int i = 0; i < 4; i++){
+		rows[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+	}
+
+	planes[0] = rows[3] + rows[0];	// Left
+	planes[1] = rows[3] - rows[0];	// Right
+	planes[2] = rows[3] + rows[1];	// Bottom
+	planes[3] = rows[3] - rows[1];	// Top
+	planes[4] = rows[3] + rows[2];	// Near
+	planes[5] = rows[3] - rows[2];	// Far
+}//====================================================
+
+//-----------------------------------------------------
+//      Action Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Determine whether an axis-aligned box lies entirely inside the frustum
+ * 
+ *  @param lo minimum corner of the box
+ *  @param hi maximum corner of the box
+ *  @return whether every point of the box is inside the frustum
+ */
+bool Frustum::contains(const glm::vec3 &lo, const glm::vec3 &hi) const{
+	for(int i = 0; i < 6; i++){
+		// The corner farthest toward the outside of the plane
+		glm::vec3 n(planes[i]);
+		glm::vec3 p(n.x >= 0 ? lo.x : hi.x, n.y >= 0 ? lo.y : hi.y, n.z >= 0 ? lo.z : hi.z);
+		if(glm::dot(n, p) + planes[i].w < 0)
+			return false;
+	}
+	return true;
+}//====================================================
+
+/**
+ *  @brief Determine whether an axis-aligned box may intersect the frustum
+ *  @details The test is conservative: a box near a corner of the frustum
+ *  may be reported as intersecting even though it lies just outside
+ * 
+ *  @param lo minimum corner of the box
+ *  @param hi maximum corner of the box
+ *  @return false if the box is certainly outside the frustum
+ */
+bool Frustum::intersects(const glm::vec3 &lo, const glm::vec3 &hi) const{
+	for(int i = 0; i < 6; i++){
+		// The corner farthest toward the inside of the plane
+		glm::vec3 n(planes[i]);
+		glm::vec3 p(n.x >= 0 ? hi.x : lo.x, n.y >= 0 ? hi.y : lo.y, n.z >= 0 ? hi.z : lo.z);
+		if(glm::dot(n, p) + planes[i].w < 0)
+			return false;
+	}
+	return true;
+}//====================================================
+
+}// End of gui namespace
+}// End of astrohelion namespace
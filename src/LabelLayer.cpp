@@ -0,0 +1,358 @@
+/**
+ *  @file LabelLayer.cpp
+ *	@brief Text labels anchored to world positions, decluttered on screen
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+
+/*
+ *	Astrohelion
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LabelLayer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace astrohelion{
+namespace gui{
+
+const float LabelLayer::DEFAULT_PADDING = 2.f;
+
+/** Width and height of each cell of the occupancy grid, pixels */
+static const float LABEL_CELL_SIZE = 32.f;
+
+//-----------------------------------------------------
+//      *structors
+//-----------------------------------------------------
+
+/**
+ *  @brief Construct an empty label layer
+ *  @param pLabelFont font the labels are measured and drawn with; not owned
+ */
+LabelLayer::LabelLayer(Font *pLabelFont) : pFont(pLabelFont) {}
+
+/**
+ *  @brief Destructor; releases the retained text in the font
+ */
+LabelLayer::~LabelLayer(){
+	if(pFont && textHandle >= 0)
+		pFont->destroyText(textHandle);
+}//====================================================
+
+//-----------------------------------------------------
+//      Action Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Add a label
+ * 
+ *  @param anchor world position the label is attached to
+ *  @param text Text (UTF-8)
+ *  @param priority labels with higher priority are kept when labels overlap
+ *  @param color RGB normalized color vector (values 0 - 1)
+ *  @param scale scaling factor for the font
+ *  @return the index of the label; indices are used by getVisible()
+ */
+int LabelLayer::addLabel(const glm::vec3 &anchor, const std::string &text, float priority,
+	const glm::vec3 &color, float scale){
+
+	Label label;
+	label.text = text;
+	label.color = color;
+	label.scale = scale;
+	label.priority = priority;
+
+	anchors.insert(anchors.end(), {anchor.x, anchor.y, anchor.z});
+	labels.push_back(label);
+	bSorted = false;
+	bValid = false;
+	return static_cast<int>(labels.size() - 1);
+}//====================================================
+
+/**
+ *  @brief Remove every label
+ */
+void LabelLayer::clear(){
+	anchors.clear();
+	labels.clear();
+	order.clear();
+	visible.clear();
+	bSorted = true;
+	bValid = false;
+}//====================================================
+
+/**
+ *  @brief Draw the labels placed by the most recent update()
+ *  @details The labels were laid out by update(), so this is a single draw
+ *  call; text queued in the font is not drawn
+ */
+void LabelLayer::draw(){
+	if(!pFont || textHandle < 0 || visible.empty())
+		return;
+
+	pFont->drawText(textHandle, 0, 0);
+}//====================================================
+
+/**
+ *  @brief Force the next call to update() to place the labels again
+ */
+void LabelLayer::invalidate(){ bValid = false; }
+
+/**
+ *  @brief Reserve storage for a number of labels
+ *  @param n number of labels
+ */
+void LabelLayer::reserve(size_t n){
+	anchors.reserve(3*n);
+	labels.reserve(n);
+}//====================================================
+
+/**
+ *  @brief Place the labels for a view
+ *  @details Nothing is done if the view, the viewport, and the labels are
+ *  unchanged since the previous update. Otherwise, every anchor is projected
+ *  to the screen, and the labels are visited by decreasing priority; a label
+ *  is placed if its anchor is in front of the camera, its box is inside the
+ *  viewport, and its box (grown by the padding) does not overlap the box of
+ *  a label placed before it. The placed labels are then laid out into the
+ *  retained text drawn by draw().
+ * 
+ *  @param view view matrix, e.g., from CameraFPS::getViewMatrix()
+ *  @param projection perspective projection matrix
+ *  @param viewport size of the viewport, pixels
+ *  @return whether the labels were placed again
+ */
+bool LabelLayer::update(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec2 &viewport){
+	glm::mat4 viewProj = projection*view;
+	if(bValid && viewProj == lastViewProj && viewport == lastViewport)
+		return false;
+
+	lastViewProj = viewProj;
+	lastViewport = viewport;
+	bValid = true;
+
+	visible.clear();
+	runs.clear();
+	if(labels.empty() || viewport.x < 1 || viewport.y < 1){
+		uploadText();
+		return true;
+	}
+
+	if(pFont){
+		for(Label &label : labels){
+			if(!label.bMeasured){
+				pFont->measureText(label.text, label.scale, &label.boxMin, &label.boxMax);
+				label.bMeasured = true;
+			}
+		}
+	}
+	sortLabels();
+
+	// Project every anchor in one pass; anchors behind the camera are marked with NaN
+	size_t n = labels.size();
+	screenPos.resize(n);
+	const float nan = std::nanf("");
+	for(size_t i = 0; i < n; i++){
+		glm::vec4 clip = viewProj*glm::vec4(anchors[3*i], anchors[3*i+1], anchors[3*i+2], 1.f);
+		screenPos[i] = clip.w > 0 ? (0.5f*glm::vec2(clip)/clip.w + 0.5f)*viewport : glm::vec2(nan, nan);
+	}
+
+	// Occupancy grid; the cells are reused between updates
+	int cols = static_cast<int>(std::ceil(viewport.x/LABEL_CELL_SIZE));
+	int rows = static_cast<int>(std::ceil(viewport.y/LABEL_CELL_SIZE));
+	for(size_t c : usedCells){
+		if(c < cells.size())
+			cells[c].clear();
+	}
+	usedCells.clear();
+	cells.resize(static_cast<size_t>(cols)*rows);
+	boxes.clear();
+
+	for(unsigned int ix : order){
+		const glm::vec2 &anchor = screenPos[ix];
+		if(anchor.x != anchor.x)	// Behind the camera
+			continue;
+
+		const Label &label = labels[ix];
+		glm::vec2 origin = glm::floor(anchor + offset);
+		glm::vec4 box(origin + label.boxMin, origin + label.boxMax);
+		if(box.x < 0 || box.y < 0 || box.z > viewport.x || box.w > viewport.y)
+			continue;
+
+		// Grow the box by the padding so that placed labels keep a gap between them
+		glm::vec4 padBox(box.x - padding, box.y - padding, box.z + padding, box.w + padding);
+		int cx0 = std::max(0, static_cast<int>(padBox.x/LABEL_CELL_SIZE));
+		int cy0 = std::max(0, static_cast<int>(padBox.y/LABEL_CELL_SIZE));
+		int cx1 = std::min(cols - 1, static_cast<int>(padBox.z/LABEL_CELL_SIZE));
+		int cy1 = std::min(rows - 1, static_cast<int>(padBox.w/LABEL_CELL_SIZE));
+
+		bool bOverlaps = false;
+		for(int cy = cy0; cy <= cy1 && !bOverlaps; cy++){
+			for(int cx = cx0; cx <= cx1 && !bOverlaps; cx++){
+				for(unsigned int b : cells[static_cast<size_t>(cy)*cols + cx]){
+					const glm::vec4 &other = boxes[b];
+					if(padBox.x < other.z && other.x < padBox.z && padBox.y < other.w && other.y < padBox.w){
+						bOverlaps = true;
+						break;
+					}
+				}
+			}
+		}
+		if(bOverlaps)
+			continue;
+
+		unsigned int b = static_cast<unsigned int>(boxes.size());
+		boxes.push_back(box);
+		for(int cy = cy0; cy <= cy1; cy++){
+			for(int cx = cx0; cx <= cx1; cx++){
+				size_t c = static_cast<size_t>(cy)*cols + cx;
+				if(cells[c].empty())
+					usedCells.push_back(c);
+				cells[c].push_back(b);
+			}
+		}
+
+		visible.push_back(ix);
+
+		TextRun run;
+		run.str = label.text;
+		run.origin = origin;
+		run.scale = label.scale;
+		run.color = label.color;
+		runs.push_back(run);
+	}
+
+	uploadText();
+	return true;
+}//====================================================
+
+//-----------------------------------------------------
+//      Set and Get Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Retrieve the font the labels are drawn with
+ *  @return the font; may be nullptr
+ */
+Font* LabelLayer::getFont() const { return pFont; }
+
+/**
+ *  @brief Retrieve the number of labels
+ *  @return the number of labels
+ */
+size_t LabelLayer::getNumLabels() const { return labels.size(); }
+
+/**
+ *  @brief Retrieve the number of labels placed by the most recent update()
+ *  @return the number of labels placed by the most recent update()
+ */
+size_t LabelLayer::getNumVisible() const { return visible.size(); }
+
+/**
+ *  @brief Retrieve the position of the text relative to its anchor
+ *  @return the position of the text origin relative to the projected anchor, pixels
+ */
+glm::vec2 LabelLayer::getOffset() const { return offset; }
+
+/**
+ *  @brief Retrieve the minimum gap between labels
+ *  @return the minimum gap between labels, pixels
+ */
+float LabelLayer::getPadding() const { return padding; }
+
+/**
+ *  @brief Retrieve the labels placed by the most recent update()
+ *  @return the indices (see addLabel()) of the placed labels, by decreasing priority
+ */
+const std::vector<unsigned int>& LabelLayer::getVisible() const { return visible; }
+
+/**
+ *  @brief Set the font the labels are measured and drawn with
+ *  @param pNewFont font; not owned
+ */
+void LabelLayer::setFont(Font *pNewFont){
+	if(pFont && textHandle >= 0)
+		pFont->destroyText(textHandle);
+	textHandle = -1;
+
+	pFont = pNewFont;
+	for(Label &label : labels){
+		label.bMeasured = false;
+	}
+	bValid = false;
+}//====================================================
+
+/**
+ *  @brief Set the position of the text relative to its anchor
+ *  @param o position of the text origin relative to the projected anchor, pixels
+ */
+void LabelLayer::setOffset(const glm::vec2 &o){
+	offset = o;
+	bValid = false;
+}//====================================================
+
+/**
+ *  @brief Set the minimum gap between labels
+ *  @param px gap, pixels; negative values are set to zero
+ */
+void LabelLayer::setPadding(float px){
+	padding = std::max(px, 0.f);
+	bValid = false;
+}//====================================================
+
+//-----------------------------------------------------
+//      Utility Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Order the labels by decreasing priority, if they have changed
+ */
+void LabelLayer::sortLabels(){
+	if(bSorted && order.size() == labels.size())
+		return;
+
+	order.resize(labels.size());
+	for(size_t i = 0; i < order.size(); i++){
+		order[i] = static_cast<unsigned int>(i);
+	}
+	std::stable_sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b){
+		return labels[a].priority > labels[b].priority;
+	});
+	bSorted = true;
+}//====================================================
+
+/**
+ *  @brief Lay out the visible labels into the retained text of the font
+ *  @details The retained text is created by the first call
+ */
+void LabelLayer::uploadText(){
+	if(!pFont)
+		return;
+
+	if(textHandle < 0)
+		textHandle = pFont->createText(runs);
+	else
+		pFont->updateText(textHandle, runs);
+}//====================================================
+
+}// End of gui namespace
+}// End of astrohelion namespace
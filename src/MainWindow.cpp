@@ -29,16 +29,14 @@
 
 #include "MainWindow.hpp"
 
+#include <cmath>
 #include <cstdio>
+#include <string>
 
 #include "App.hpp"
 #include "GLErrorHandling.hpp"
 #include "ResourceManager.hpp"
-
-// Includes for Astrohelion Demo
-#include "astrohelion/SysData_bc4bp.hpp"
-#include "astrohelion/Traj_bc4bp.hpp"
-#include "astrohelion/Utilities.hpp"
+#include "TrajCache.hpp"
 
 namespace astrohelion{
 namespace gui{
@@ -64,44 +62,23 @@ void MainWindow::init(){
     if(!GLOBAL_APP->getResMan()){
         throw std::runtime_error("MainWindow::init: Resource Manager has not been loaded; cannot init window");
     }
-    GLOBAL_APP->getResMan()->loadShader("../shaders/billboard.vert", "../shaders/billboard.frag", "../shaders/hexagon.geom", "billboard");
-
-    // Load the BC4BP system from the file
-    // SysData_bc4bp bcSys("../../Astrohelion_scripts/LPF/data/LPF_QH_4B_NaturalManifolds_flyby/Traj019_SEM.mat");
-    SysData_bc4bp bcSys("../data/seDPO_37_sp_sem.mat");
-    // Load the trajectory from the file
-    // Traj_bc4bp natArc("../../Astrohelion_scripts/LPF/data/LPF_QH_4B_NaturalManifolds_flyby/Traj019_SEM.mat", &bcSys);
-    Traj_bc4bp natArc("../data/seDPO_37_sp_sem.mat", &bcSys);
-
-    std::vector<float> points, endPts, endPtColors;
-    std::vector<float> red {1.f, 0.f, 0.f, 1.f};
-    std::vector<float> green {0.f, 1.f, 0.f, 1.f};
-
-    points.reserve(natArc.getNumNodes()*3);
-    for(int i = 0; i < natArc.getNumNodes(); i++){
-        std::vector<double> state = natArc.getStateByIx(i);
-        
-        points.push_back(static_cast<float>(state[0]));
-        points.push_back(static_cast<float>(state[1]));
-        points.push_back(static_cast<float>(state[2]));
-
-        if(i == 0 || i == natArc.getNumNodes()-1){
-            endPts.push_back(static_cast<float>(state[0]));
-            endPts.push_back(static_cast<float>(state[1]));
-            endPts.push_back(static_cast<float>(state[2])); 
-
-            if(i == 0)
-                endPtColors.insert(endPtColors.end(), green.begin(), green.end());
-            else
-                endPtColors.insert(endPtColors.end(), red.begin(), red.end());
-        }
+    GLOBAL_APP->getResMan()->loadShader("../shaders/billboard.vert", "../shaders/billboard.frag", nullptr, "billboard");
+
+    // Labels are optional; the window works without them if the font cannot be loaded
+    try{
+        pLabelFont.reset(new Font(pWindow));
+        pLabelFont->initFont("../fonts/UbuntuMono-Regular.ttf", 14);
+        nodeLabels.setFont(pLabelFont.get());
+        clusterLabels.setFont(pLabelFont.get());
+    }catch(std::exception &e){
+        printf("MainWindow: Could not load label font: %s\n", e.what());
+        pLabelFont.reset();
     }
 
-    line.createFromPoints(points);
+    // Load the trajectory on a worker thread; the data is uploaded as it arrives (see updateLoading())
+    // loader.start("../../Astrohelion_scripts/LPF/data/LPF_QH_4B_NaturalManifolds_flyby/Traj019_SEM.mat");
+    loader.start("../data/seDPO_37_sp_sem.mat");
     line.setThickness(2);
-    
-    bill = BillboardSet(endPts, endPtColors);
-    bill.init();
 
     camera = CameraFPS(glm::vec3(0.0f, 0.0f, 3.f));
     camera.setScreenProperties(0,0, width, height);
@@ -112,6 +89,9 @@ void MainWindow::init(){
 void MainWindow::update(){
     Window::update();
 
+    updateLoading();
+    updateSceneImport();
+
 	if(bKeyPressed[GLFW_KEY_W])
 		camera.processKeyboard(CamMove_tp::FORWARD, frame_dt);
 	if(bKeyPressed[GLFW_KEY_S])
@@ -128,13 +108,56 @@ void MainWindow::update(){
     camera.getViewMatrix(&view);
     projection = glm::perspective(camera.getZoom(), (GLfloat)width / (GLfloat)height, 0.1f, 1000.0f);
 
-    GLOBAL_APP->getResMan()->getShader("line_thick").setMatrix4("modelViewProjectionMatrix", projection*view, true);
-    GLOBAL_APP->getResMan()->getShader("line_thick").setVector2f("viewportSize", width, height);
+    if(bUseLOD)
+        line.selectLOD(view, projection, height);
+
+    if(bUseCulling && sceneIndex.getNumChunks() > 0){
+        sceneIndex.cull(camera.getFrustum(projection));
+        if(lineIndexID >= 0)
+            line.setVisibleRanges(sceneIndex.getVisibleRanges(lineIndexID));
+        for(size_t i = 0; i < sceneIndexIDs.size(); i++){
+            sceneLines.setVisibleRanges(i, sceneIndex.getVisibleRanges(sceneIndexIDs[i]));
+        }
+    }
+
+    // The camera itself reaches the shaders through the Camera uniform block (see Window::render())
+    GLOBAL_APP->getResMan()->getShader("billboard").setVector2f("offset", 0, 0, true);
 
-    GLOBAL_APP->getResMan()->getShader("billboard").setMatrix4("viewProj", projection*view, true);
-    GLOBAL_APP->getResMan()->getShader("billboard").setVector2f("offset", 0, 0);
-    GLOBAL_APP->getResMan()->getShader("billboard").setVector2f("viewportSize", width, height);
-    GLOBAL_APP->getResMan()->getShader("billboard").setFloat("radius", 20);
+    if(bClusterMarkers && sceneClusters.getNumMarkers() > 0 &&
+        sceneClusters.update(view, projection, glm::vec2(width, height))){
+
+        // The number of clusters is bounded by the viewport area, so the set rarely grows
+        size_t n = sceneClusters.getNumClusters();
+        if(n > clusterBill.getCapacity()){
+            size_t cap = std::max(n, 2*clusterBill.getCapacity());
+            clusterBill.destroy();
+            clusterBill = BillboardSet();
+            clusterBill.initDynamic(cap);
+        }
+        if(n > 0){
+            clusterBill.update(0, n, &(sceneClusters.getPoints()[0]), &(sceneClusters.getColors()[0]),
+                &(sceneClusters.getRadii()[0]));
+        }
+        clusterBill.setNumPoints(n);
+
+        // Label each aggregate marker with its count; larger clusters win when labels overlap
+        clusterLabels.clear();
+        if(pLabelFont){
+            const std::vector<float> &pts = sceneClusters.getPoints();
+            const std::vector<unsigned int> &counts = sceneClusters.getCounts();
+            for(size_t i = 0; i < n; i++){
+                if(counts[i] > 1){
+                    clusterLabels.addLabel(glm::vec3(pts[3*i], pts[3*i+1], pts[3*i+2]), std::to_string(counts[i]),
+                        static_cast<float>(counts[i]), glm::vec3(1.f, 1.f, 1.f), 0.8f);
+                }
+            }
+        }
+    }
+
+    if(bNodeLabels)
+        nodeLabels.update(view, projection, glm::vec2(width, height));
+    if(bClusterMarkers)
+        clusterLabels.update(view, projection, glm::vec2(width, height));
 
     checkForGLErrors("MainWindow::update()");
 }//====================================================
@@ -152,15 +175,303 @@ void MainWindow::draw(){
                 camera.resetView();
             }
         }
+
+        if(ImGui::CollapsingHeader("Rendering")){
+            ImGui::Text("Thick lines:");
+            bool bChanged = ImGui::RadioButton("Geometry shader", &lineRenderRadio, 0); ImGui::SameLine();
+            bChanged |= ImGui::RadioButton("Vertex pulling", &lineRenderRadio, 1);
+            if(bChanged)
+                line.setRenderMode(lineRenderRadio == 0 ? LineRender_tp::GEOMETRY_SHADER : LineRender_tp::VERTEX_PULL);
+
+            if(ImGui::Checkbox("Level of detail", &bUseLOD) && !bUseLOD)
+                line.setLODLevel(-1);
+            ImGui::Text("Drawing %zu of %zu nodes (level %d of %zu)", line.getNumDrawnPoints(),
+                line.getNumPoints(), line.getLODLevel(), line.getNumLODLevels());
+
+            if(ImGui::Checkbox("Frustum culling", &bUseCulling) && !bUseCulling){
+                line.clearVisibleRanges();
+                sceneLines.clearVisibleRanges();
+            }
+            if(bUseCulling){
+                ImGui::Text("%zu of %zu segments in view (%zu of %zu chunks)", sceneIndex.getNumVisibleSegments(),
+                    sceneIndex.getNumSegments(), sceneIndex.getNumVisibleChunks(), sceneIndex.getNumChunks());
+            }
+
+            bool bNodesChanged = ImGui::Checkbox("Node markers", &bNodeMarkers);
+            if(bNodeMarkers){
+                bNodesChanged |= ImGui::SliderInt("Node stride", &nodeMarkerStride, 1, 1000);
+                if(bNodesChanged){
+                    nodeBill.initFromLine(&line, 0, static_cast<size_t>(std::max(nodeMarkerStride, 1)));
+                    nodeBill.setShape(BillboardShape_tp::CIRCLE);
+                    nodeBill.setRadius(6);
+                    nodeBill.setColor(0.9f, 0.9f, 0.9f, 1.f);
+                }
+                ImGui::Text("%zu node markers", nodeBill.getNumPoints());
+            }
+
+            if(pLabelFont && !line.getEpochs().empty()){
+                bool bLabelsChanged = ImGui::Checkbox("Node labels", &bNodeLabels);
+                if(bNodeLabels){
+                    if(bLabelsChanged || (bNodesChanged && bNodeMarkers))
+                        rebuildNodeLabels();
+                    ImGui::Text("%zu of %zu labels placed", nodeLabels.getNumVisible(), nodeLabels.getNumLabels());
+                }
+            }
+
+            if(!line.getEpochs().empty()){
+                ImGui::Checkbox("Time window", &bTimeWindow);
+                if(bTimeWindow){
+                    ImGui::SliderFloat("End", &timeWindowEnd, 0.f, 1.f);
+                    ImGui::SliderFloat("Length", &timeWindowLength, 0.f, 1.f);
+                    ImGui::Checkbox("Fade trail", &bFadeTrail);
+                }
+            }
+        }
+
+        if(ImGui::CollapsingHeader("Data")){
+            int numNodes = loader.getNumNodes();
+            if(!loader.getError().empty()){
+                ImGui::TextWrapped("Load failed: %s", loader.getError().c_str());
+            }else if(numNodes < 0){
+                ImGui::Text("Parsing trajectory file...");
+            }else{
+                float frac = numNodes > 0 ? static_cast<float>(line.getNumPoints())/numNodes : 1.f;
+                ImGui::ProgressBar(frac);
+                ImGui::Text("%zu / %d nodes", line.getNumPoints(), numNodes);
+            }
+
+            ImGui::Separator();
+            ImGui::InputText("Directory", scenePathBuf, sizeof(scenePathBuf));
+            if(ImGui::Button("Import Scene"))
+                startSceneImport();
+
+            if(importer.getNumFiles() > 0){
+                size_t numFiles = importer.getNumFiles();
+                ImGui::ProgressBar(static_cast<float>(importer.getNumUploaded())/numFiles);
+                ImGui::Text("%zu parsed, %zu uploaded of %zu files (%.2f s)", importer.getNumParsed(),
+                    importer.getNumUploaded(), numFiles, importer.getElapsedTime());
+            }
+
+            ImGui::Checkbox("Cluster markers", &bClusterMarkers);
+            if(bClusterMarkers){
+                if(ImGui::SliderFloat("Separation (px)", &clusterSeparation, 1.f, 100.f))
+                    sceneClusters.setMinSeparation(clusterSeparation);
+                ImGui::Text("%zu clusters of %zu markers", sceneClusters.getNumClusters(), sceneClusters.getNumMarkers());
+            }
+        }
         ImGui::End();
     }
 
-    line.draw();
+    if(bTimeWindow && !line.getEpochs().empty()){
+        // The window trails its end in the direction of propagation
+        const std::vector<double> &epochs = line.getEpochs();
+        double tof = epochs.back() - epochs.front();
+        double tEnd = epochs.front() + timeWindowEnd*tof;
+        line.setFadeAge(bFadeTrail ? std::abs(timeWindowLength*tof) : 0);
+        line.draw(tEnd - timeWindowLength*tof, tEnd);
+
+        // Mark the most recent point in the window
+        size_t first = 0, count = 0;
+        if(line.findTimeRange(tEnd - timeWindowLength*tof, tEnd, &first, &count)){
+            if(!headBill.isDynamic())
+                headBill.initDynamic(1);
+
+            glm::vec3 head = line.getPoint(first + count - 1);
+            const float headColor[] = {1.f, 0.85f, 0.2f, 1.f};
+            headBill.update(0, 1, &(head.x), headColor);
+            headBill.draw();
+        }
+    }else{
+        line.draw();
+    }
     bill.draw();
+    if(bNodeMarkers)
+        nodeBill.draw();
+
+    sceneLines.draw();
+    if(bClusterMarkers && sceneClusters.getNumMarkers() > 0)
+        clusterBill.draw();
+    else
+        sceneBill.draw();
+
+    // Labels are drawn on top of the scene
+    bool bClusterLabels = bClusterMarkers && sceneClusters.getNumMarkers() > 0;
+    if(bNodeLabels || bClusterLabels){
+        GLboolean bDepthWasEnabled = glIsEnabled(GL_DEPTH_TEST);
+        glDisable(GL_DEPTH_TEST);
+        if(bNodeLabels)
+            nodeLabels.draw();
+        if(bClusterLabels)
+            clusterLabels.draw();
+        if(bDepthWasEnabled)
+            glEnable(GL_DEPTH_TEST);
+    }
 
     checkForGLErrors("MainWindow::draw()");
 }//====================================================
 
+/**
+ *  @brief Upload trajectory data delivered by the background loader
+ *  @details At most maxChunksPerFrame chunks are uploaded each frame
+ *  so that a large trajectory cannot stall the event loop.
+ */
+void MainWindow::updateLoading(){
+    if(bLoadComplete)
+        return;
+
+    std::shared_ptr<TrajCache> cache = loader.takeCache();
+    if(cache){
+        // The cache holds the complete, GPU-ready line; upload it in one step
+        line.createFromCache(cache);
+        bLineReserved = true;
+    }
+
+    if(!bLineReserved && loader.getNumNodes() > 0){
+        line.reserve(loader.getNumNodes());
+        bLineReserved = true;
+    }
+
+    std::vector<float> chunk;
+    for(int c = 0; c < maxChunksPerFrame && loader.popChunk(chunk); c++){
+        line.append(chunk);
+    }
+
+    if(loader.isFinished()){
+        // The levels of detail were computed by the loader's worker thread; only upload them here
+        std::vector<LineLOD> levels;
+        std::vector<unsigned int> lodIx;
+        loader.takeLOD(levels, lodIx);
+        line.setLOD(levels, lodIx);
+
+        // Epochs of a line loaded from a cache are set by Polyline::createFromCache()
+        std::vector<double> epochs = loader.getEpochs();
+        if(epochs.size() == line.getNumPoints())
+            line.setEpochs(epochs);
+
+        TrajMarkers markers = loader.getMarkers();
+        if(!markers.points.empty()){
+            bill.destroy();
+            bill = BillboardSet(markers.points, markers.colors);
+            bill.init();
+        }
+
+        if(!loader.getError().empty())
+            printf("MainWindow: Failed to load trajectory: %s\n", loader.getError().c_str());
+
+        rebuildSceneIndex();
+
+        bLoadComplete = true;
+    }
+}//====================================================
+
+/**
+ *  @brief Import every trajectory file in the directory entered in the GUI
+ *  @details Lines from a previous import are released first
+ */
+void MainWindow::startSceneImport(){
+    importer.stop();
+
+    sceneLines.clear();
+    sceneBill.destroy();
+    sceneBill = BillboardSet();
+    sceneClusters.clear();
+    clusterLabels.clear();
+    rebuildSceneIndex();
+
+    std::vector<std::string> files;
+    try{
+        files = SceneImporter::listDirectory(scenePathBuf);
+    }catch(std::exception &e){
+        printf("MainWindow: %s\n", e.what());
+        return;
+    }
+
+    importer.start(files);
+    bSceneReported = false;
+}//====================================================
+
+/**
+ *  @brief Upload lines finished by the scene importer
+ *  @details Uploads are limited to a few milliseconds per frame; once every
+ *  line is uploaded, the markers are combined into a single BillboardSet
+ */
+void MainWindow::updateSceneImport(){
+    if(bSceneReported)
+        return;
+
+    importer.uploadReady(sceneLines);
+
+    if(importer.isFinished()){
+        std::vector<float> pts, colors;
+        for(const SceneArc &arc : importer.getArcs()){
+            pts.insert(pts.end(), arc.markers.points.begin(), arc.markers.points.end());
+            colors.insert(colors.end(), arc.markers.colors.begin(), arc.markers.colors.end());
+        }
+
+        if(!pts.empty()){
+            sceneBill.destroy();
+            sceneBill = BillboardSet(pts, colors);
+            sceneBill.init(VertexEncoding_tp::QUANTIZED16);
+            sceneClusters.build(pts, colors);
+        }
+
+        importer.printReport();
+        bSceneReported = true;
+        rebuildSceneIndex();
+    }
+}//====================================================
+
+/**
+ *  @brief Label the epochs of every nodeMarkerStride-th node of the trajectory line
+ *  @details Labels further apart along the line have higher priority, so
+ *  zooming out thins the labels evenly rather than keeping one crowded stretch
+ */
+void MainWindow::rebuildNodeLabels(){
+    nodeLabels.clear();
+
+    const std::vector<double> &epochs = line.getEpochs();
+    size_t stride = static_cast<size_t>(std::max(nodeMarkerStride, 1));
+    if(epochs.size() != line.getNumPoints())
+        return;
+
+    nodeLabels.reserve(epochs.size()/stride + 1);
+    char text[32];
+    for(size_t i = 0, k = 0; i < epochs.size(); i += stride, k++){
+        // Priority is the number of times k is divisible by two; the first label has the highest
+        int priority = 0;
+        for(size_t j = k; j > 0 && (j & 1) == 0 && priority < 32; j >>= 1){ priority++; }
+        if(k == 0)
+            priority = 32;
+
+        snprintf(text, sizeof(text), "%.3f", epochs[i]);
+        nodeLabels.addLabel(line.getPoint(i), text, static_cast<float>(priority), glm::vec3(0.9f, 0.9f, 0.9f), 0.9f);
+    }
+}//====================================================
+
+/**
+ *  @brief Index the chunks of the trajectory line and every imported line
+ *  @details Lines that are not indexed are never culled
+ */
+void MainWindow::rebuildSceneIndex(){
+    sceneIndex.clear();
+    sceneIndexIDs.clear();
+    lineIndexID = -1;
+
+    line.clearVisibleRanges();
+    sceneLines.clearVisibleRanges();
+
+    if(line.getPointsPtr() && line.getNumPoints() >= 2)
+        lineIndexID = sceneIndex.addLine(line.getPointsPtr(), line.getNumPoints());
+
+    for(size_t i = 0; i < sceneLines.getNumLines(); i++){
+        int id = static_cast<int>(i);
+        sceneIndexIDs.push_back(sceneIndex.addLine(sceneLines.getPointsPtr(id), sceneLines.getNumPoints(id),
+            PolylineBatch::POINT_STRIDE));
+    }
+
+    sceneIndex.build();
+}//====================================================
+
 void MainWindow::handleMouseMoveEvent(double xpos, double ypos){
     Window::handleMouseMoveEvent(xpos, ypos);
 
@@ -175,11 +486,10 @@ void MainWindow::handleMouseButtonEvent(int button, int action, int mods){
     // See if the user clicked on an object
 
     // Convert all clickable points to screen coordinates
-    const std::vector<float>& worldPts = line.getPointsRef();
-    std::vector<double> screenPts (worldPts.size(), 0);
+    std::vector<double> screenPts (3*line.getNumPoints(), 0);
 
-    for(unsigned int p = 0; p < worldPts.size()/3; p++){
-        glm::vec4 worldPt(worldPts[3*p+0], worldPts[3*p+1], worldPts[3*p+2], 1);
+    for(unsigned int p = 0; p < line.getNumPoints(); p++){
+        glm::vec4 worldPt(line.getPoint(p), 1);
         
         // Project the world point into screen space (centered at (0,0), extents of [-1, 1] in both directions)
         glm::vec4 screenPt = projection*view*worldPt;
@@ -205,6 +515,8 @@ void MainWindow::handleWindowSizeEvent(int w, int h){
     Window::handleWindowSizeEvent(w, h);
 
     camera.setScreenProperties(0,0,w,h);
+    if(pLabelFont)
+        pLabelFont->updateWindow(pWindow);
 }//====================================================
 
 }// END of gui namespace
@@ -35,16 +35,53 @@
 #include "GL/glew.h"
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 
 #include "App.hpp"
 #include "ResourceManager.hpp"
 #include "Polyline.hpp"
+#include "Shader.hpp"
+#include "TrajCache.hpp"
 
 namespace astrohelion{
 namespace gui{
 
+const unsigned int Polyline::VERTEX_STRIDE = 3;
+const float Polyline::DEFAULT_COLOR[4] = {0.9f, 0.9f, 0.9f, 1.0f};
+
+Polyline::LineUniforms Polyline::geomUniforms {};
+Polyline::LineUniforms Polyline::pullUniforms {};
+
+/**
+ *  \brief Bind a buffer object as a buffer texture
+ *  \details The texture is created on first use and reattached if the buffer
+ *  has changed (e.g., after reallocation of immutable storage)
+ * 
+ *  \param unit texture unit, e.g., GL_TEXTURE0
+ *  \param buffer buffer object to expose
+ *  \param format internal format of each texel, e.g., GL_R32F
+ *  \param tex buffer texture; created if zero
+ *  \param attached buffer currently attached to <tt>tex</tt>; updated by this function
+ */
+static void bindBufferTexture(GLenum unit, GLuint buffer, GLenum format, GLuint &tex, GLuint &attached){
+	if(tex == 0)
+		glGenTextures(1, &tex);
+
+	glActiveTexture(unit);
+	glBindTexture(GL_TEXTURE_BUFFER, tex);
+	if(attached != buffer){
+		glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+		attached = buffer;
+	}
+}//====================================================
+
 Polyline::Polyline(){}
 
 Polyline::Polyline(std::vector<float> pts){
@@ -53,123 +90,761 @@ Polyline::Polyline(std::vector<float> pts){
 
 /**
  *  \brief Create a line from a set of points
+ *  \details Any data previously stored in the line is discarded, but the
+ *  OpenGL buffers are reused if they are large enough
+ *  
  *  \param pts Points (in world coordinates) that make up a line
  */
 void Polyline::createFromPoints(std::vector<float> pts){
 	if(pts.size() < 2*3)
 		throw std::runtime_error("Cannot create a polyline with fewer than two points");
 
-	this->points = pts;
-	size_t n = pts.size()/3;
-	// printf("Polyline has %zu points\n", n);
+	// The VAO of a quantized line describes a different vertex layout
+	if(encoding == VertexEncoding_tp::QUANTIZED16)
+		destroy();
 
+	pCache.reset();
 	vertices.clear();
-	indices.clear();
+	numPoints = 0;
+	clearLOD();
 
-	vertices.reserve(7*(n + 2));	// three position elements, four color elements
-	indices.reserve(4*n);
+	if(capacity < pts.size()/3)
+		allocateBuffers(pts.size()/3, GL_STATIC_DRAW);
 
-	// Begin by creating adjacency point
-	glm::vec3 first(pts[0], pts[1], pts[2]);
-	glm::vec3 second(pts[3], pts[4], pts[5]);
-	glm::vec3 adj_pre = first - glm::normalize(second - first);
+	append(pts);
+}//====================================================
 
-	vertices.push_back(adj_pre.x);
-	vertices.push_back(adj_pre.y);
-	vertices.push_back(adj_pre.z);
-	vertices.push_back(color[0]);
-	vertices.push_back(color[1]);
-	vertices.push_back(color[2]);
-	vertices.push_back(color[3]);
-
-	for(unsigned int i = 0; i < n; i++){
-		vertices.push_back(pts[3*i+0]);
-		vertices.push_back(pts[3*i+1]);
-		vertices.push_back(pts[3*i+2]);
-		vertices.push_back(color[0]);
-		vertices.push_back(color[1]);
-		vertices.push_back(color[2]);
-		vertices.push_back(color[3]);
-
-		if(i < n-1){
-			// This point begins a new segment, add the indices of the segment
-			// points and adjacency points to the vector
-			indices.push_back(i);
-			indices.push_back(i+1);
-			indices.push_back(i+2);
-			indices.push_back(i+3);
-		}
+/**
+ *  \brief Create a line from a memory-mapped trajectory cache
+ *  \details The vertex array stored in the cache is passed straight to the
+ *  GPU without being copied into an intermediate vector. The line keeps a
+ *  reference to the cache so that the points remain accessible via getPointsPtr().
+ * 
+ *  \param cache A mapped trajectory cache
+ *  \throws std::runtime_error if the cache does not describe a line
+ */
+void Polyline::createFromCache(std::shared_ptr<const TrajCache> cache){
+	if(!cache || cache->getNumPoints() < 2 || cache->getVertexStride() != VERTEX_STRIDE ||
+		cache->getNumVertices() != cache->getNumPoints() + 2){
+		throw std::runtime_error("Polyline::createFromCache: Cache does not contain a valid line");
 	}
 
-	// Append a final adjacency point
-	glm::vec3 last(pts[3*n-3], pts[3*n-2], pts[3*n-1]);
-	glm::vec3 preLast(pts[3*n-6], pts[3*n-5], pts[3*n-4]);
-	glm::vec3 adj_post = last + glm::normalize(last - preLast);
+	if(encoding == VertexEncoding_tp::QUANTIZED16)
+		destroy();
+
+	vertices.clear();
+	numPoints = 0;
+	clearLOD();
+	clearEpochs();
+	pCache = cache;
 
-	vertices.push_back(adj_post.x);
-	vertices.push_back(adj_post.y);
-	vertices.push_back(adj_post.z);
-	vertices.push_back(color[0]);
-	vertices.push_back(color[1]);
-	vertices.push_back(color[2]);
-	vertices.push_back(color[3]);
-
-	// printf("Points:\n");
-	// for(unsigned int i = 0; i < vertices.size(); i++){
-	// 	printf("%5.2f", vertices[i]);
-
-	// 	if(i!= 0 && (i+1)%7 == 0)
-	// 		printf("\n");
-	// 	else
-	// 		printf(", ");
-	// }
-
-	// printf("\nIndices:\n");
-	// for(unsigned int i = 0; i < indices.size(); i++){
-	// 	printf("%u", indices[i]);
-
-	// 	if(i!= 0 && (i+1)%4 == 0)
-	// 		printf("\n");
-	// 	else
-	// 		printf(", ");
-	// }
+	// Immutable (persistently mapped) storage cannot be respecified with glBufferData()
+	if(bPersistent)
+		releaseBuffers();
+
+	initVAO();
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, cache->getNumVertices()*VERTEX_STRIDE*sizeof(float), cache->getVertices(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	capacity = cache->getNumPoints();
+
+	if(cache->getEpochs())
+		setEpochs(std::vector<double>(cache->getEpochs(), cache->getEpochs() + cache->getNumPoints()));
+}//====================================================
+
+/**
+ *  \brief Create a line from vertex data that has already been built
+ *  \details This allows the construction of the vertex data to take place on
+ *  another thread via buildVertexData(); only the upload happens here. The
+ *  contents of the input vector are moved into the line and the vector is
+ *  left empty.
+ * 
+ *  \param verts Vertex array built by buildVertexData()
+ *  \throws std::runtime_error if the vertex data do not describe a line
+ */
+void Polyline::createFromData(std::vector<float> &verts){
+	if(verts.size() % VERTEX_STRIDE != 0 || verts.size() < VERTEX_STRIDE*(2 + 2))
+		throw std::runtime_error("Polyline::createFromData: Vertex data do not describe a line");
+
+	if(encoding == VertexEncoding_tp::QUANTIZED16)
+		destroy();
+
+	pCache.reset();
+	clearLOD();
+	clearEpochs();
+	vertices.clear();
+	vertices.swap(verts);
+	numPoints = vertices.size()/VERTEX_STRIDE - 2;
+
+	// allocateBuffers() uploads the CPU-side data
+	allocateBuffers(numPoints, GL_STATIC_DRAW);
+}//====================================================
+
+/**
+ *  \brief Create a line that stores its positions as 16-bit offsets
+ *  \details The points are split into chunks; each vertex stores its offset
+ *  from the origin of its chunk as three normalized unsigned shorts plus the
+ *  index of its chunk (8 bytes per vertex rather than 12), and the origin and
+ *  scale of each chunk are stored in a buffer texture that line_thick.vs uses
+ *  to decode the positions (see quantizePositions()). The line is still drawn
+ *  as a single GL_LINE_STRIP_ADJACENCY primitive.
+ *  
+ *  Quantized lines are always drawn with the geometry shader. The points are
+ *  available via getPoint() but not getPointsPtr(). Appending to a quantized line
+ *  converts it back to 32-bit positions.
+ * 
+ *  \param pts Points (in world coordinates) that make up a line
+ *  \param chunkSize number of consecutive vertices that share an origin and scale;
+ *  smaller chunks are more accurate
+ *  \throws std::runtime_error if fewer than two points are provided
+ */
+void Polyline::createQuantized(const std::vector<float> &pts, size_t chunkSize){
+	std::vector<float> verts;
+	buildVertexData(pts, verts);
+
+	destroy();
+	numPoints = pts.size()/3;
+	quantizePositions(&(verts[0]), numPoints + 2, chunkSize, qVertices, chunkTable);
+	encoding = VertexEncoding_tp::QUANTIZED16;
 
 	glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &VBO);
-	glGenBuffers(1, &EBO);
+	glGenBuffers(1, &chunkBuffer);
 
 	glBindVertexArray(VAO);
-
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size()*sizeof(float), &(vertices[0]), GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, qVertices.size()*sizeof(GLushort), &(qVertices[0]), GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size()*sizeof(unsigned int), &(indices[0]), GL_STATIC_DRAW);
+	// Location 0: Position within the chunk, normalized to [0, 1]
+	glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, QUANT_STRIDE*sizeof(GLushort), (GLvoid*)0);
+	glEnableVertexAttribArray(0);
 
-    // Location 0: Position
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 7*sizeof(GL_FLOAT), (GLvoid*)0);
-    glEnableVertexAttribArray(0);
+	// Location 2: Chunk index (integer)
+	glVertexAttribIPointer(2, 1, GL_UNSIGNED_SHORT, QUANT_STRIDE*sizeof(GLushort), (GLvoid*)(3*sizeof(GLushort)));
+	glEnableVertexAttribArray(2);
 
-    // Location 1: Color
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 7*sizeof(GL_FLOAT), (GLvoid*)(3*sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);   // Note that this is allowed, the call to glVertexAttribPointer registered VBO as the currently bound vertex buffer object so afterwards we can safely unbind
-    glBindVertexArray(0);   // Unbind VAO (it's always a good thing to unbind any buffer/array to prevent strange bugs), remember: do NOT unbind the EBO, keep it bound to this VAO
+	glBindBuffer(GL_TEXTURE_BUFFER, chunkBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, chunkTable.size()*sizeof(float), &(chunkTable[0]), GL_STATIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	capacity = numPoints;
 }//====================================================
 
-void Polyline::draw(){
-	Shader shader = GLOBAL_APP->getResMan()->getShader("line_thick");
-	shader.setFloat("thickness", thickness, true);
-	shader.setFloat("miterLimit", miterLimit);
+/**
+ *  \brief Delete the OpenGL objects and data owned by the line
+ *  \details Polyline objects may be copied (the copies refer to the same
+ *  OpenGL objects), so the objects are not deleted automatically; call this
+ *  function from the thread that owns the OpenGL context once the line (and
+ *  any copies of it) are no longer needed.
+ */
+void Polyline::destroy(){
+	releaseBuffers();
+	pCache.reset();
+	vertices.clear();
+	qVertices.clear();
+	chunkTable.clear();
+	epochs.clear();
+	numPoints = 0;
+	encoding = VertexEncoding_tp::FLOAT32;
+}//====================================================
+
+/**
+ *  \brief Append points to the end of the line
+ *  \details Only the new vertices (and the trailing adjacency vertex they
+ *  replace) are uploaded to the GPU; previously uploaded data is left untouched
+ *  unless the buffer must be enlarged, in which case the capacity is (at least)
+ *  doubled. Appending N points therefore costs O(N) amortized time regardless of
+ *  the length of the line. When ARB_buffer_storage is available, the data are
+ *  written directly into a persistently mapped buffer without waiting for the
+ *  GPU; only the replaced trailing adjacency vertex, which the previous draw
+ *  may still read, is uploaded with glBufferSubData(). Points are stored until
+ *  at least two are available, at which point the line is drawable.
+ *  
+ *  This function must be called from the thread that owns the OpenGL context.
+ * 
+ *  \param pts Points (in world coordinates) to add to the end of the line
+ *  \throws std::runtime_error if the number of elements in <tt>pts</tt> is not
+ *  a multiple of three
+ */
+void Polyline::append(const std::vector<float> &pts){
+	if(pts.size() % 3 != 0)
+		throw std::runtime_error("Polyline::append: Points vector must contain three elements per point");
+
+	if(pts.empty())
+		return;
+
+	if(pCache)
+		detachCache();
+
+	if(encoding == VertexEncoding_tp::QUANTIZED16)
+		detachQuantized();
+
+	// The simplified levels and epochs no longer describe the line
+	clearLOD();
+	clearEpochs();
+
+	size_t nPrev = numPoints;
+	size_t n = nPrev + pts.size()/3;
+	size_t firstVert = 0;
+
+	if(nPrev >= 2){
+		// Remove the trailing adjacency vertex; it is replaced by the first new point
+		vertices.resize(VERTEX_STRIDE*(nPrev + 1));
+		firstVert = nPrev + 1;
+	}else if(vertices.empty()){
+		vertices.assign(VERTEX_STRIDE, 0.f);	// Placeholder for the leading adjacency vertex
+	}
+
+	vertices.insert(vertices.end(), pts.begin(), pts.end());
+	numPoints = n;
+
+	if(n < 2)
+		return;		// Cannot form a segment yet
+
+	if(nPrev < 2){
+		// The first segment is now known; compute the leading adjacency vertex
+		glm::vec3 first(vertices[3], vertices[4], vertices[5]);
+		glm::vec3 second(vertices[6], vertices[7], vertices[8]);
+		glm::vec3 adj_pre = first - glm::normalize(second - first);
+		vertices[0] = adj_pre.x;
+		vertices[1] = adj_pre.y;
+		vertices[2] = adj_pre.z;
+	}
+
+	// Append a final adjacency vertex; point i is stored in vertex i+1
+	glm::vec3 last(vertices[3*n], vertices[3*n+1], vertices[3*n+2]);
+	glm::vec3 preLast(vertices[3*n-3], vertices[3*n-2], vertices[3*n-1]);
+	glm::vec3 adj_post = last + glm::normalize(last - preLast);
+	pushVertex(adj_post.x, adj_post.y, adj_post.z);
+
+	if(n > capacity){
+		// Buffers are too small; grow geometrically so that a line built by many
+		// small appends is reallocated O(log n) times rather than once per append
+		allocateBuffers(std::max(n, 2*capacity), GL_DYNAMIC_DRAW);
+	}else if(bPersistent){
+		// The old trailing adjacency vertex may still be read by the previous draw,
+		// so it is replaced through the command stream, which orders the write after
+		// that draw. Every later vertex lies past the end of what has been drawn and
+		// is written straight into the mapped storage without waiting for the GPU.
+		size_t firstMapped = firstVert;
+		if(nPrev >= 2){
+			glBindBuffer(GL_ARRAY_BUFFER, VBO);
+			glBufferSubData(GL_ARRAY_BUFFER, VERTEX_STRIDE*firstVert*sizeof(float),
+				VERTEX_STRIDE*sizeof(float), &(vertices[VERTEX_STRIDE*firstVert]));
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			firstMapped++;
+		}
+		memcpy(pMappedVerts + VERTEX_STRIDE*firstMapped, &(vertices[VERTEX_STRIDE*firstMapped]),
+			(vertices.size() - VERTEX_STRIDE*firstMapped)*sizeof(float));
+	}else{
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferSubData(GL_ARRAY_BUFFER, VERTEX_STRIDE*firstVert*sizeof(float),
+			(vertices.size() - VERTEX_STRIDE*firstVert)*sizeof(float), &(vertices[VERTEX_STRIDE*firstVert]));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}//====================================================
+
+/**
+ *  \brief Allocate space for a line with a known number of points
+ *  \details Reserving space before a series of calls to append() avoids
+ *  repeated reallocation of the CPU and GPU storage.
+ * 
+ *  \param n Number of points the line will store
+ */
+void Polyline::reserve(size_t n){
+	if(pCache)
+		detachCache();
+
+	if(encoding == VertexEncoding_tp::QUANTIZED16)
+		detachQuantized();
+
+	vertices.reserve(VERTEX_STRIDE*(n + 2));
+
+	if(n > capacity)
+		allocateBuffers(n, GL_DYNAMIC_DRAW);
+}//====================================================
+
+/**
+ *  \brief Replace a contiguous range of points
+ *  \details Only the modified vertices are uploaded, along with the leading
+ *  or trailing adjacency vertex if the range reaches the first or last segment;
+ *  the existing OpenGL objects are kept. An edit of k points therefore costs
+ *  O(k) regardless of the length of the line. The data are uploaded with
+ *  glBufferSubData() even when the buffer is persistently mapped, so the edit
+ *  never waits for the GPU to finish the previous draw.
+ *  
+ *  The levels of detail are discarded, since they no longer describe the line;
+ *  the epochs are kept. This function must be called from the thread that owns
+ *  the OpenGL context.
+ * 
+ *  \param firstNode index of the first point to replace
+ *  \param pts new points (x, y, z for each point)
+ *  \throws std::runtime_error if the number of elements in <tt>pts</tt> is not
+ *  a multiple of three
+ *  \throws std::out_of_range if the range extends beyond the end of the line
+ */
+void Polyline::updateRange(size_t firstNode, const std::vector<float> &pts){
+	if(pts.size() % 3 != 0)
+		throw std::runtime_error("Polyline::updateRange: Points vector must contain three elements per point");
+
+	size_t k = pts.size()/3;
+	size_t n = getNumPoints();
+	if(firstNode + k > n)
+		throw std::out_of_range("Polyline::updateRange: Range extends beyond the end of the line");
+
+	if(k == 0)
+		return;
+
+	if(pCache)
+		detachCache();
+
+	if(encoding == VertexEncoding_tp::QUANTIZED16)
+		detachQuantized();
+
+	clearLOD();
+
+	// Point i is stored in vertex i+1
+	std::copy(pts.begin(), pts.end(), vertices.begin() + VERTEX_STRIDE*(firstNode + 1));
+
+	if(n < 2)
+		return;		// No segments (and no adjacency vertices) yet
+
+	size_t lastNode = firstNode + k - 1;
+	size_t firstVert = firstNode + 1;	// First vertex to upload
+	size_t endVert = lastNode + 2;		// One past the last vertex to upload
+
+	if(firstNode <= 1){
+		// The leading adjacency vertex depends on the first two points
+		glm::vec3 first(vertices[3], vertices[4], vertices[5]);
+		glm::vec3 second(vertices[6], vertices[7], vertices[8]);
+		glm::vec3 adj_pre = first - glm::normalize(second - first);
+		vertices[0] = adj_pre.x;
+		vertices[1] = adj_pre.y;
+		vertices[2] = adj_pre.z;
+		firstVert = 0;
+	}
+
+	if(lastNode + 2 >= n){
+		// The trailing adjacency vertex depends on the final two points
+		glm::vec3 last(vertices[3*n], vertices[3*n+1], vertices[3*n+2]);
+		glm::vec3 preLast(vertices[3*n-3], vertices[3*n-2], vertices[3*n-1]);
+		glm::vec3 adj_post = last + glm::normalize(last - preLast);
+		vertices[3*(n+1)] = adj_post.x;
+		vertices[3*(n+1)+1] = adj_post.y;
+		vertices[3*(n+1)+2] = adj_post.z;
+		endVert = n + 2;
+	}
+
+	if(VAO == 0 || capacity < n){
+		// The buffers were released (e.g., by detachQuantized()); upload everything
+		allocateBuffers(n, GL_DYNAMIC_DRAW);
+	}else{
+		// The range may still be read by the previous draw, so it is written through
+		// the command stream rather than the persistent mapping (if any); the driver
+		// orders the write after that draw without blocking the CPU
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferSubData(GL_ARRAY_BUFFER, VERTEX_STRIDE*firstVert*sizeof(float),
+			VERTEX_STRIDE*(endVert - firstVert)*sizeof(float), &(vertices[VERTEX_STRIDE*firstVert]));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}//====================================================
+
+/**
+ *  \brief Build the simplified levels of detail for the line
+ *  \details This may take some time for long lines; see computeLOD(). The levels
+ *  are discarded when the line is modified.
+ */
+void Polyline::buildLOD(){
+	std::vector<LineLOD> levels;
+	std::vector<unsigned int> ix;
+
+	if(encoding == VertexEncoding_tp::QUANTIZED16){
+		// Simplify the decoded points so that the tolerances match what is drawn
+		std::vector<float> pts;
+		pts.reserve(3*numPoints);
+		for(size_t i = 0; i < numPoints; i++){
+			glm::vec3 p = getPoint(i);
+			pts.insert(pts.end(), {p.x, p.y, p.z});
+		}
+		computeLOD(pts.empty() ? nullptr : &(pts[0]), numPoints, levels, ix);
+	}else{
+		computeLOD(getPointsPtr(), getNumPoints(), levels, ix);
+	}
+	setLOD(levels, ix);
+}//====================================================
+
+/**
+ *  \brief Discard the simplified levels of detail; the full line is drawn
+ *  \details The LOD index buffer is kept for reuse
+ */
+void Polyline::clearLOD(){
+	lodLevels.clear();
+	lodLevel = -1;
+}//====================================================
+
+/**
+ *  \brief Draw every segment of the line; see setVisibleRanges()
+ */
+void Polyline::clearVisibleRanges(){
+	visibleRanges.clear();
+	bCulled = false;
+}//====================================================
+
+/**
+ *  \brief Set the simplified levels of detail for the line
+ *  \details This allows the levels to be computed on another thread via
+ *  computeLOD(); only the upload happens here.
+ * 
+ *  \param levels levels computed by computeLOD(), ordered from finest to coarsest
+ *  \param ix index array computed by computeLOD()
+ */
+void Polyline::setLOD(const std::vector<LineLOD> &levels, const std::vector<unsigned int> &ix){
+	clearLOD();
+
+	size_t n = getNumPoints();
+	if(levels.empty() || ix.empty() || n == 0 || VAO == 0)
+		return;
+
+	boundsMin = boundsMax = getPoint(0);
+	for(size_t i = 1; i < n; i++){
+		glm::vec3 p = getPoint(i);
+		boundsMin = glm::min(boundsMin, p);
+		boundsMax = glm::max(boundsMax, p);
+	}
+
+	if(lodEBO == 0)
+		glGenBuffers(1, &lodEBO);
+
+	// The full line is drawn without indices, so the LOD indices are the VAO's only element buffer
 	glBindVertexArray(VAO);
-	glDrawElements(GL_LINES_ADJACENCY, 4*(points.size()+2), GL_UNSIGNED_INT, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lodEBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, ix.size()*sizeof(unsigned int), &(ix[0]), GL_STATIC_DRAW);
 	glBindVertexArray(0);
+
+	lodLevels = levels;
 }//====================================================
 
-const std::vector<float>& Polyline::getPointsRef(){ return points; }
+/**
+ *  \brief Select the level of detail drawn by draw() for the current view
+ *  \details The coarsest level whose tolerance, projected onto the screen at
+ *  the point of the line's bounding box closest to the camera, is no larger
+ *  than the maximum pixel error is selected. The full line is drawn when the
+ *  camera is inside the bounding box or no level is coarse enough.
+ * 
+ *  \param view view matrix, e.g., from CameraFPS::getViewMatrix()
+ *  \param projection perspective projection matrix
+ *  \param viewportHeight height of the viewport, pixels
+ */
+void Polyline::selectLOD(const glm::mat4 &view, const glm::mat4 &projection, float viewportHeight){
+	lodLevel = -1;
+	if(lodLevels.empty())
+		return;
+
+	glm::vec3 eye(glm::inverse(view)[3]);
+	float dist = glm::length(eye - glm::clamp(eye, boundsMin, boundsMax));
+	if(dist <= 0)
+		return;
+
+	// Screen pixels spanned by one world unit at the closest distance
+	float pxPerUnit = 0.5f*projection[1][1]*viewportHeight/dist;
+	for(int i = static_cast<int>(lodLevels.size()) - 1; i >= 0; i--){
+		if(lodLevels[i].tolerance*pxPerUnit <= maxPixelError){
+			lodLevel = i;
+			break;
+		}
+	}
+}//====================================================
 
-void Polyline::setColor(float r, float g, float b, float a){}
+/**
+ *  \brief Draw the line
+ *  \details The full line is drawn as a single GL_LINE_STRIP_ADJACENCY primitive
+ *  without an index buffer; a level of detail chosen by selectLOD() is drawn from
+ *  its indices. If visible ranges have been set (see setVisibleRanges()) and no
+ *  level of detail is selected, only those ranges are drawn, with one multi-draw
+ *  call. Quantized lines are always drawn with the geometry shader. The
+ *  camera is read from the Camera uniform block, which the window uploads
+ *  before drawing (see Window::uploadCameraUniforms()).
+ */
+void Polyline::draw(){
+	size_t n = getNumPoints();
+	if(VAO == 0 || n < 2)
+		return;
+
+	if(lodLevel >= 0){
+		const LineLOD *pLevel = &(lodLevels[lodLevel]);
+		drawSegments({SegmentRange(0, pLevel->numIndices/4)}, pLevel, false, 0);
+	}else if(bCulled){
+		// Ranges set before the line was shortened are clipped to the current line
+		std::vector<SegmentRange> ranges;
+		for(const SegmentRange &range : visibleRanges){
+			if(range.first < n - 1)
+				ranges.push_back(SegmentRange(range.first, std::min(range.count, n - 1 - range.first)));
+		}
+
+		if(!ranges.empty())
+			drawSegments(ranges, nullptr, false, 0);
+	}else{
+		drawSegments({SegmentRange(0, n - 1)}, nullptr, false, 0);
+	}
+}//====================================================
+
+/**
+ *  \brief Draw the part of the line between two epochs
+ *  \details The range is resolved to a contiguous set of points by a binary
+ *  search over the epochs (see findTimeRange()) and drawn at full resolution
+ *  from an offset into the existing vertex buffer, so changing the range from
+ *  frame to frame requires no buffer updates. Visible ranges set by
+ *  setVisibleRanges() are not applied. If a fade age is set (see
+ *  setFadeAge()), the line fades out with the age of each point, measured from
+ *  the end of the range in the direction of propagation.
+ *  
+ *  The full line is drawn if the epochs have not been set.
+ * 
+ *  \param t0 epoch at one end of the range
+ *  \param t1 epoch at the other end of the range
+ */
+void Polyline::draw(double t0, double t1){
+	if(epochs.empty()){
+		draw();
+		return;
+	}
+
+	size_t first = 0, count = 0;
+	if(VAO == 0 || !findTimeRange(t0, t1, &first, &count) || count < 2)
+		return;
+
+	// Ages are measured from the most recent end of the range
+	double tNow = bEpochsDescending ? std::min(t0, t1) : std::max(t0, t1);
+	drawSegments({SegmentRange(first, count - 1)}, nullptr, fadeAge > 0, static_cast<float>(tNow - epochs[0]));
+}//====================================================
+
+/**
+ *  \brief Locate the points whose epochs lie within a range
+ *  \details The epochs are monotonic, so the points form a contiguous range
+ *  that is located with a binary search
+ * 
+ *  \param t0 epoch at one end of the range
+ *  \param t1 epoch at the other end of the range
+ *  \param pFirst receives the index of the first point in the range
+ *  \param pCount receives the number of points in the range
+ *  \return whether or not any points lie within the range; false if the
+ *  epochs have not been set
+ */
+bool Polyline::findTimeRange(double t0, double t1, size_t *pFirst, size_t *pCount) const{
+	*pFirst = 0;
+	*pCount = 0;
+	if(epochs.empty())
+		return false;
+
+	if(t1 < t0)
+		std::swap(t0, t1);
+
+	std::vector<double>::const_iterator itFirst, itEnd;
+	if(bEpochsDescending){
+		itFirst = std::lower_bound(epochs.begin(), epochs.end(), t1, std::greater<double>());
+		itEnd = std::upper_bound(epochs.begin(), epochs.end(), t0, std::greater<double>());
+	}else{
+		itFirst = std::lower_bound(epochs.begin(), epochs.end(), t0);
+		itEnd = std::upper_bound(epochs.begin(), epochs.end(), t1);
+	}
+
+	if(itEnd <= itFirst)
+		return false;
+
+	*pFirst = itFirst - epochs.begin();
+	*pCount = itEnd - itFirst;
+	return true;
+}//====================================================
+
+/**
+ *  \brief Retrieve the number of points stored in the line
+ *  \return the number of points stored in the line
+ */
+size_t Polyline::getNumPoints() const { return pCache ? pCache->getNumPoints() : numPoints; }
+
+/**
+ *  \brief Retrieve the number of points drawn at the selected level of detail
+ *  \return the number of points drawn at the selected level of detail
+ */
+size_t Polyline::getNumDrawnPoints() const{
+	if(lodLevel >= 0)
+		return lodLevels[lodLevel].numIndices/4 + 1;
+
+	if(bCulled){
+		size_t count = 0;
+		for(const SegmentRange &range : visibleRanges){
+			count += range.count + 1;
+		}
+		return std::min(count, getNumPoints());
+	}
+
+	return getNumPoints();
+}//====================================================
+
+/**
+ *  \brief Retrieve the level of detail selected by selectLOD()
+ *  \return the index of the selected level, or -1 if the full line is drawn
+ */
+int Polyline::getLODLevel() const { return lodLevel; }
+
+/**
+ *  \brief Retrieve the number of simplified levels of detail
+ *  \return the number of simplified levels of detail
+ */
+size_t Polyline::getNumLODLevels() const { return lodLevels.size(); }
+
+/**
+ *  \brief Retrieve the format of the positions stored on the GPU
+ *  \return the format of the positions stored on the GPU
+ */
+VertexEncoding_tp Polyline::getEncoding() const { return encoding; }
+
+/**
+ *  \brief Retrieve the epoch of each point
+ *  \return the epochs, or an empty vector if they have not been set
+ */
+const std::vector<double>& Polyline::getEpochs() const { return epochs; }
+
+/**
+ *  \brief Retrieve a point on the line
+ *  \details Quantized points are decoded, so the result matches what is drawn
+ * 
+ *  \param i index of the point
+ *  \return the point, world coordinates
+ *  \throws std::out_of_range if the point does not exist
+ */
+glm::vec3 Polyline::getPoint(size_t i) const{
+	if(i >= getNumPoints())
+		throw std::out_of_range("Polyline::getPoint: Index out of range");
+
+	if(encoding == VertexEncoding_tp::QUANTIZED16)
+		return dequantizePosition(&(qVertices[QUANT_STRIDE*(i + 1)]), &(chunkTable[0]));
+
+	const float *p = getPointsPtr() + 3*i;
+	return glm::vec3(p[0], p[1], p[2]);
+}//====================================================
+
+/**
+ *  \brief Retrieve the buffer that stores the chunk table of a quantized line
+ *  \return the buffer that stores the chunk table, or zero if the line is not quantized
+ */
+unsigned int Polyline::getChunkBuffer() const { return chunkBuffer; }
+
+/**
+ *  \brief Retrieve the method used to expand the line into triangles
+ *  \return the method used to expand the line into triangles
+ */
+LineRender_tp Polyline::getRenderMode() const { return renderMode; }
+
+/**
+ *  \brief Retrieve a pointer to the points that make up the line
+ *  \details The points are stored contiguously (between the two adjacency
+ *  vertices) for lines created by any method, including from a trajectory cache,
+ *  except createQuantized(); use getPoint() for quantized lines
+ *  \return a pointer to the points (x, y, z for each point); see getNumPoints()
+ *  for the number of points. Null if the line is empty or quantized
+ */
+const float* Polyline::getPointsPtr() const{
+	if(pCache)
+		return pCache->getPoints();
+
+	return numPoints == 0 || encoding == VertexEncoding_tp::QUANTIZED16 ? nullptr : &(vertices[VERTEX_STRIDE]);
+}//====================================================
+
+/**
+ *  \brief Retrieve the vertex buffer of the line
+ *  \details Vertex i + 1 of the buffer stores point i; the first and last
+ *  vertices are adjacency vertices. Each vertex holds VERTEX_STRIDE floats, or
+ *  QUANT_STRIDE unsigned shorts if the line is quantized. The buffer may be
+ *  replaced when the line grows (see append()).
+ *  \return the vertex buffer object, or zero if the line has not been uploaded
+ */
+unsigned int Polyline::getVBO() const { return VBO; }
+
+/**
+ *  \brief Set the line color
+ *  \details The color is applied as a uniform when the line is drawn, so it
+ *  may be changed at any time without modifying the vertex data
+ * 
+ *  \param r red value, between 0 and 1
+ *  \param g green value, between 0 and 1
+ *  \param b blue value, between 0 and 1
+ *  \param a alpha value, between 0 and 1
+ */
+void Polyline::setColor(float r, float g, float b, float a){
+	color[0] = r;
+	color[1] = g;
+	color[2] = b;
+	color[3] = a;
+}//====================================================
+
+/**
+ *  \brief Set the epoch of each point
+ *  \details The epochs allow sub-ranges of the line to be drawn by time;
+ *  see draw(double, double). They are uploaded once and discarded when the
+ *  line is modified.
+ * 
+ *  \param t epoch of each point; must be monotonic (increasing or decreasing)
+ *  \throws std::runtime_error if the number of epochs does not match the
+ *  number of points or the epochs are not monotonic
+ */
+void Polyline::setEpochs(const std::vector<double> &t){
+	if(t.size() != getNumPoints())
+		throw std::runtime_error("Polyline::setEpochs: Number of epochs does not match the number of points");
+
+	if(t.empty()){
+		clearEpochs();
+		return;
+	}
+
+	bool bDescending = t.back() < t.front();
+	for(size_t i = 1; i < t.size(); i++){
+		if(bDescending ? t[i] > t[i-1] : t[i] < t[i-1])
+			throw std::runtime_error("Polyline::setEpochs: Epochs must be monotonic");
+	}
+
+	epochs = t;
+	bEpochsDescending = bDescending;
+	uploadEpochs();
+}//====================================================
+
+/**
+ *  \brief Set the age at which draw(double, double) fades the line out completely
+ *  \param age age, in the same units as the epochs; zero disables the fade
+ */
+void Polyline::setFadeAge(double age){ fadeAge = age; }
+
+/**
+ *  \brief Set the level of detail drawn by draw(), bypassing selectLOD()
+ *  \param level index of the level; -1 draws the full line
+ *  \throws std::out_of_range if the level does not exist
+ */
+void Polyline::setLODLevel(int level){
+	if(level < -1 || level >= static_cast<int>(lodLevels.size()))
+		throw std::out_of_range("Polyline::setLODLevel: Level does not exist");
+
+	lodLevel = level;
+}//====================================================
+
+/**
+ *  \brief Set the largest screen-space error allowed by selectLOD()
+ *  \param px maximum distance between the drawn and full lines, pixels
+ */
+void Polyline::setMaxPixelError(float px){ maxPixelError = px; }
+
+/**
+ *  \brief Set the method used to expand the line into triangles
+ *  \details Both methods produce the same triangles; VERTEX_PULL avoids the
+ *  geometry shader stage, which is slow on some drivers (notably software
+ *  renderers). The mode may be changed at any time.
+ * 
+ *  \param mode render mode
+ */
+void Polyline::setRenderMode(LineRender_tp mode){ renderMode = mode; }
 
 /**
  *  @brief Set the line thickness
@@ -177,6 +852,522 @@ void Polyline::setColor(float r, float g, float b, float a){}
  */
 void Polyline::setThickness(float t){ thickness = t; }
 
+/**
+ *  \brief Limit the full-resolution line drawn by draw() to a set of segment ranges
+ *  \details This is typically the output of SceneBVH::cull() for the current
+ *  view; an empty set draws nothing. The ranges are ignored while a level of
+ *  detail is selected, since a simplified line has few segments to cull.
+ * 
+ *  \param ranges ordered, non-overlapping ranges of segments to draw
+ */
+void Polyline::setVisibleRanges(const std::vector<SegmentRange> &ranges){
+	visibleRanges = ranges;
+	bCulled = true;
+}//====================================================
+
+/**
+ *  \brief (Re)allocate the GPU vertex buffer
+ *  \details The VAO and VBO are created the first time this function is
+ *  called and reused afterwards. Any vertex data already stored on the CPU is
+ *  uploaded to the new storage.
+ *  
+ *  Dynamic buffers (<tt>usage</tt> = GL_DYNAMIC_DRAW) are allocated as immutable,
+ *  persistently mapped storage when ARB_buffer_storage is available; immutable
+ *  storage cannot be resized, so the buffers are recreated in that case.
+ * 
+ *  \param cap Number of points the buffer must be able to store
+ *  \param usage OpenGL usage hint, e.g., GL_STATIC_DRAW
+ */
+void Polyline::allocateBuffers(size_t cap, GLenum usage){
+	if(cap < 2)
+		cap = 2;
+
+	bool bMap = usage == GL_DYNAMIC_DRAW && GLEW_ARB_buffer_storage;
+	if(bPersistent || (bMap && VAO != 0))
+		releaseBuffers();
+
+	initVAO();
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+	// Allocate storage for cap points plus two adjacency vertices
+	GLsizeiptr vertBytes = VERTEX_STRIDE*(cap + 2)*sizeof(float);
+
+	if(bMap){
+		// Dynamic storage allows glBufferSubData() for the vertices a draw may still read
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, vertBytes, nullptr, flags | GL_DYNAMIC_STORAGE_BIT);
+		pMappedVerts = static_cast<float*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, vertBytes, flags));
+
+		if(!pMappedVerts){
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			releaseBuffers();
+			throw std::runtime_error("Polyline::allocateBuffers: Could not map buffer storage");
+		}
+		bPersistent = true;
+
+		if(!vertices.empty())
+			memcpy(pMappedVerts, &(vertices[0]), vertices.size()*sizeof(float));
+	}else{
+		glBufferData(GL_ARRAY_BUFFER, vertBytes, nullptr, usage);
+
+		if(!vertices.empty())
+			glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size()*sizeof(float), &(vertices[0]));
+	}
+
+	capacity = cap;
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}//====================================================
+
+/**
+ *  \brief Issue the draw call for a set of segment ranges
+ * 
+ *  \param ranges segments to draw; when a level of detail is drawn, only the
+ *  number of segments in the first range is used and every segment of the level is drawn
+ *  \param pLevel level of detail to draw, or nullptr to draw from the full line
+ *  \param bFade whether to fade the line out by age
+ *  \param fadeEnd epoch at which the age is zero, relative to the first point
+ */
+void Polyline::drawSegments(const std::vector<SegmentRange> &ranges, const LineLOD *pLevel, bool bFade, float fadeEnd){
+	bool bQuantized = encoding == VertexEncoding_tp::QUANTIZED16;
+	bool bPull = renderMode == LineRender_tp::VERTEX_PULL && !bQuantized;
+	bFade = bFade && epochVBO != 0;
+
+	// Each segment is nine vertices of a GL_TRIANGLES draw when pulled, and
+	// segment s reads vertices s through s+3 of the strip otherwise
+	std::vector<GLint> firsts(ranges.size());
+	std::vector<GLsizei> counts(ranges.size());
+	for(size_t r = 0; r < ranges.size(); r++){
+		firsts[r] = static_cast<GLint>(bPull ? 9*ranges[r].first : ranges[r].first);
+		counts[r] = static_cast<GLsizei>(bPull ? 9*ranges[r].count : ranges[r].count + 3);
+	}
+
+	// The fade is applied through the alpha channel
+	GLboolean bBlendWasEnabled = glIsEnabled(GL_BLEND);
+	if(bFade && !bBlendWasEnabled){
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+
+	if(bPull){
+		Shader &shader = GLOBAL_APP->getResMan()->getShader("line_thick_pull");
+		resolveUniforms(shader, true, &pullUniforms);
+		const LineUniforms &u = pullUniforms;
+
+		shader.setFloat(u.thickness, thickness, true);
+		shader.setFloat(u.miterLimit, miterLimit);
+		shader.setVector4f(u.lineColor, color[0], color[1], color[2], color[3]);
+		shader.setInteger(u.vertexData, 0);
+		shader.setInteger(u.vertexStride, VERTEX_STRIDE);
+		shader.setInteger(u.indexData, 1);
+		shader.setInteger(u.bIndexed, pLevel ? 1 : 0);
+		shader.setInteger(u.indexOffset, pLevel ? pLevel->firstIndex : 0);
+		shader.setInteger(u.epochData, 2);
+		shader.setInteger(u.bFade, bFade ? 1 : 0);
+		shader.setFloat(u.fadeEnd, fadeEnd);
+		shader.setFloat(u.fadeAge, static_cast<float>(fadeAge));
+
+		bindBufferTexture(GL_TEXTURE0, VBO, GL_R32F, pullTexture, pullTextureVBO);
+		if(pLevel)
+			bindBufferTexture(GL_TEXTURE1, lodEBO, GL_R32UI, lodTexture, lodTextureEBO);
+		if(bFade)
+			bindBufferTexture(GL_TEXTURE2, epochVBO, GL_R32F, epochTexture, epochTextureVBO);
+
+		// No attributes are read, but core profiles require a VAO to be bound to draw;
+		// each segment is expanded into nine vertices
+		glBindVertexArray(VAO);
+		glMultiDrawArrays(GL_TRIANGLES, &(firsts[0]), &(counts[0]), static_cast<GLsizei>(ranges.size()));
+		glBindVertexArray(0);
+
+		for(GLenum unit : {GL_TEXTURE2, GL_TEXTURE1, GL_TEXTURE0}){
+			glActiveTexture(unit);
+			glBindTexture(GL_TEXTURE_BUFFER, 0);
+		}
+	}else{
+		Shader &shader = GLOBAL_APP->getResMan()->getShader("line_thick");
+		resolveUniforms(shader, false, &geomUniforms);
+		const LineUniforms &u = geomUniforms;
+
+		shader.setFloat(u.thickness, thickness, true);
+		shader.setFloat(u.miterLimit, miterLimit);
+		shader.setVector4f(u.lineColor, color[0], color[1], color[2], color[3]);
+		shader.setInteger(u.bQuantized, bQuantized ? 1 : 0);
+		shader.setInteger(u.bFade, bFade ? 1 : 0);
+		shader.setFloat(u.fadeEnd, fadeEnd);
+		shader.setFloat(u.fadeAge, static_cast<float>(fadeAge));
+		if(bQuantized){
+			shader.setInteger(u.chunkTable, 0);
+			bindBufferTexture(GL_TEXTURE0, chunkBuffer, GL_RGBA32F, chunkTexture, chunkTextureBuffer);
+		}
+
+		glBindVertexArray(VAO);
+		if(pLevel)
+			glDrawElements(GL_LINES_ADJACENCY, pLevel->numIndices, GL_UNSIGNED_INT, (GLvoid*)(pLevel->firstIndex*sizeof(unsigned int)));
+		else
+			glMultiDrawArrays(GL_LINE_STRIP_ADJACENCY, &(firsts[0]), &(counts[0]), static_cast<GLsizei>(ranges.size()));
+		glBindVertexArray(0);
+
+		if(bQuantized)
+			glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+
+	if(bFade && !bBlendWasEnabled)
+		glDisable(GL_BLEND);
+}//====================================================
+
+/**
+ *  \brief Look up the uniform locations of a thick line shader
+ *  \details Nothing is done if the locations were already resolved for the
+ *  program currently stored in the shader, so this is cheap to call before
+ *  every draw; it only queries the shader after it is (re)compiled.
+ * 
+ *  \param shader "line_thick" or "line_thick_pull" shader
+ *  \param bPull whether the shader is "line_thick_pull"
+ *  \param pLocs Receives the locations
+ */
+void Polyline::resolveUniforms(Shader &shader, bool bPull, LineUniforms *pLocs){
+	if(pLocs->program == shader.getID())
+		return;
+
+	LineUniforms locs;
+	locs.program = shader.getID();
+	locs.thickness = shader.getUniformLocation("thickness");
+	locs.miterLimit = shader.getUniformLocation("miterLimit");
+	locs.lineColor = shader.getUniformLocation("lineColor");
+	locs.bFade = shader.getUniformLocation("bFade");
+	locs.fadeEnd = shader.getUniformLocation("fadeEnd");
+	locs.fadeAge = shader.getUniformLocation("fadeAge");
+	if(bPull){
+		locs.vertexData = shader.getUniformLocation("vertexData");
+		locs.vertexStride = shader.getUniformLocation("vertexStride");
+		locs.indexData = shader.getUniformLocation("indexData");
+		locs.bIndexed = shader.getUniformLocation("bIndexed");
+		locs.indexOffset = shader.getUniformLocation("indexOffset");
+		locs.epochData = shader.getUniformLocation("epochData");
+	}else{
+		locs.bQuantized = shader.getUniformLocation("bQuantized");
+		locs.chunkTable = shader.getUniformLocation("chunkTable");
+	}
+	*pLocs = locs;
+}//====================================================
+
+/**
+ *  \brief Create the VAO and VBO and describe the vertex layout
+ *  \details Nothing is done if the objects already exist
+ */
+void Polyline::initVAO(){
+	if(VAO != 0)
+		return;
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+    // Location 0: Position; the color is a uniform
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE*sizeof(GL_FLOAT), (GLvoid*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);   // Note that this is allowed, the call to glVertexAttribPointer registered VBO as the currently bound vertex buffer object so afterwards we can safely unbind
+    glBindVertexArray(0);
+
+    // Location 1: Epoch, stored in a separate buffer
+    uploadEpochs();
+}//====================================================
+
+/**
+ *  \brief Discard the epochs of the points
+ *  \details The epoch attribute is disabled so that a line that has grown
+ *  since the epochs were set never reads past the end of the epoch buffer
+ */
+void Polyline::clearEpochs(){
+	epochs.clear();
+
+	if(VAO != 0 && epochVBO != 0){
+		glBindVertexArray(VAO);
+		glDisableVertexAttribArray(1);
+		glBindVertexArray(0);
+	}
+}//====================================================
+
+/**
+ *  \brief Copy the data from the trajectory cache into the CPU-side array
+ *  \details This is required before the line can be modified; the cache
+ *  reference is released afterwards. The GPU buffer is not modified.
+ */
+void Polyline::detachCache(){
+	if(!pCache)
+		return;
+
+	const float *pVerts = pCache->getVertices();
+	vertices.assign(pVerts, pVerts + VERTEX_STRIDE*pCache->getNumVertices());
+	numPoints = pCache->getNumPoints();
+	pCache.reset();
+}//====================================================
+
+/**
+ *  \brief Decode the quantized vertices into the CPU-side array
+ *  \details This is required before the line can be modified. The GPU
+ *  buffers, which describe the quantized layout, are released; they are
+ *  reallocated with 32-bit positions when the line is next uploaded.
+ */
+void Polyline::detachQuantized(){
+	if(encoding != VertexEncoding_tp::QUANTIZED16)
+		return;
+
+	vertices.clear();
+	vertices.reserve(VERTEX_STRIDE*(numPoints + 2));
+	for(size_t v = 0; v < numPoints + 2; v++){
+		glm::vec3 p = dequantizePosition(&(qVertices[QUANT_STRIDE*v]), &(chunkTable[0]));
+		pushVertex(p.x, p.y, p.z);
+	}
+
+	releaseBuffers();
+	qVertices.clear();
+	chunkTable.clear();
+	encoding = VertexEncoding_tp::FLOAT32;
+}//====================================================
+
+/**
+ *  \brief Add a vertex to the vertex array
+ * 
+ *  \param x x-coordinate, world coordinates
+ *  \param y y-coordinate, world coordinates
+ *  \param z z-coordinate, world coordinates
+ */
+void Polyline::pushVertex(float x, float y, float z){
+	vertices.push_back(x);
+	vertices.push_back(y);
+	vertices.push_back(z);
+}//====================================================
+
+/**
+ *  \brief Delete the OpenGL objects owned by the line
+ *  \details A persistently mapped buffer is unmapped first. The CPU-side
+ *  vertex data and epochs are not modified, but the levels of detail (which are stored
+ *  only on the GPU) are discarded.
+ */
+void Polyline::releaseBuffers(){
+	if(VAO != 0){
+		if(bPersistent && pMappedVerts){
+			glBindBuffer(GL_ARRAY_BUFFER, VBO);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+	}
+
+	if(pullTexture != 0)
+		glDeleteTextures(1, &pullTexture);
+	if(lodTexture != 0)
+		glDeleteTextures(1, &lodTexture);
+	if(lodEBO != 0)
+		glDeleteBuffers(1, &lodEBO);
+	if(chunkTexture != 0)
+		glDeleteTextures(1, &chunkTexture);
+	if(chunkBuffer != 0)
+		glDeleteBuffers(1, &chunkBuffer);
+	if(epochTexture != 0)
+		glDeleteTextures(1, &epochTexture);
+	if(epochVBO != 0)
+		glDeleteBuffers(1, &epochVBO);
+
+	VAO = VBO = 0;
+	pullTexture = pullTextureVBO = 0;
+	lodEBO = lodTexture = lodTextureEBO = 0;
+	chunkBuffer = chunkTexture = chunkTextureBuffer = 0;
+	epochVBO = epochTexture = epochTextureVBO = 0;
+	capacity = 0;
+	bPersistent = false;
+	pMappedVerts = nullptr;
+	clearLOD();
+}//====================================================
+
+/**
+ *  \brief Upload the epochs and attach them to the VAO (location 1)
+ *  \details Each vertex stores its epoch relative to the first point as a
+ *  float; the adjacency vertices copy the epochs of their neighbors. Nothing
+ *  is done if the epochs or VAO do not exist.
+ */
+void Polyline::uploadEpochs(){
+	size_t n = epochs.size();
+	if(n == 0 || VAO == 0)
+		return;
+
+	std::vector<float> rel(n + 2);
+	for(size_t i = 0; i < n; i++){
+		rel[i + 1] = static_cast<float>(epochs[i] - epochs[0]);
+	}
+	rel[0] = rel[1];
+	rel[n + 1] = rel[n];
+
+	if(epochVBO == 0)
+		glGenBuffers(1, &epochVBO);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, epochVBO);
+	glBufferData(GL_ARRAY_BUFFER, rel.size()*sizeof(float), &(rel[0]), GL_STATIC_DRAW);
+	glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (GLvoid*)0);
+	glEnableVertexAttribArray(1);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}//====================================================
+
+//-----------------------------------------------------
+//      Static Functions
+//-----------------------------------------------------
+
+/**
+ *  \brief Construct the vertex array that describes a line
+ *  \details The vertex array contains an adjacency vertex before the first point,
+ *  one vertex per point, and an adjacency vertex after the last point; each vertex
+ *  stores VERTEX_STRIDE floats (position). The line is drawn from this array as a
+ *  single GL_LINE_STRIP_ADJACENCY primitive, so no index array is required.
+ *  
+ *  This function does not require an OpenGL context.
+ * 
+ *  \param pts Points (in world coordinates) that make up a line; at least two are required
+ *  \param verts Receives the vertex array; any previous contents are discarded
+ *  \throws std::runtime_error if fewer than two points are provided
+ */
+void Polyline::buildVertexData(const std::vector<float> &pts, std::vector<float> &verts){
+	if(pts.size() < 2*3)
+		throw std::runtime_error("Polyline::buildVertexData: Cannot create a polyline with fewer than two points");
+
+	size_t n = pts.size()/3;
+	verts.clear();
+	verts.reserve(VERTEX_STRIDE*(n + 2));
+
+	// Begin by creating adjacency point
+	glm::vec3 first(pts[0], pts[1], pts[2]);
+	glm::vec3 second(pts[3], pts[4], pts[5]);
+	glm::vec3 adj_pre = first - glm::normalize(second - first);
+
+	// Append a final adjacency point
+	glm::vec3 last(pts[3*n-3], pts[3*n-2], pts[3*n-1]);
+	glm::vec3 preLast(pts[3*n-6], pts[3*n-5], pts[3*n-4]);
+	glm::vec3 adj_post = last + glm::normalize(last - preLast);
+
+	verts.push_back(adj_pre.x);
+	verts.push_back(adj_pre.y);
+	verts.push_back(adj_pre.z);
+	verts.insert(verts.end(), pts.begin(), pts.begin() + 3*n);
+	verts.push_back(adj_post.x);
+	verts.push_back(adj_post.y);
+	verts.push_back(adj_post.z);
+}//====================================================
+
+/**
+ *  \brief Compute simplified levels of detail for a line
+ *  \details A Douglas-Peucker simplification is run to completion once; each
+ *  point is assigned the largest tolerance at which it survives (clamped to
+ *  the tolerance of the point that split its parent interval so that the
+ *  levels are nested). A level at tolerance t then contains exactly the points
+ *  a Douglas-Peucker pass at tolerance t would keep. Tolerances are powers of
+ *  two times the size of the line's bounding box, and a level is kept only if
+ *  it has at most half the points of the next finer level, so all levels
+ *  together use fewer indices than the full line.
+ *  
+ *  Each level indexes the line's vertex array (adjacency vertex, points,
+ *  adjacency vertex) with four indices per segment, like the full line.
+ *  This function does not require an OpenGL context.
+ * 
+ *  \param pts Points (in world coordinates) that make up the line (x, y, z for each point)
+ *  \param n Number of points
+ *  \param levels Receives the levels, ordered from finest to coarsest; any previous
+ *  contents are discarded
+ *  \param ix Receives the indices of every level; any previous contents are discarded
+ */
+void Polyline::computeLOD(const float *pts, size_t n, std::vector<LineLOD> &levels, std::vector<unsigned int> &ix){
+	levels.clear();
+	ix.clear();
+	if(!pts || n < 3)
+		return;
+
+	glm::dvec3 lo(pts[0], pts[1], pts[2]), hi = lo;
+	for(size_t i = 1; i < n; i++){
+		glm::dvec3 p(pts[3*i], pts[3*i+1], pts[3*i+2]);
+		lo = glm::min(lo, p);
+		hi = glm::max(hi, p);
+	}
+	double extent = glm::length(hi - lo);
+	if(extent <= 0)
+		return;
+
+	// Assign each point the tolerance at which it is removed; an explicit stack
+	// avoids deep recursion on long lines
+	const float keep = std::numeric_limits<float>::max();
+	std::vector<float> err(n, 0);
+	err[0] = err[n-1] = keep;
+
+	struct Interval{ size_t a, b; float parentErr; };
+	std::vector<Interval> stack {Interval {0, n-1, keep}};
+	while(!stack.empty()){
+		Interval iv = stack.back();
+		stack.pop_back();
+		if(iv.b - iv.a < 2)
+			continue;
+
+		glm::dvec3 A(pts[3*iv.a], pts[3*iv.a+1], pts[3*iv.a+2]);
+		glm::dvec3 B(pts[3*iv.b], pts[3*iv.b+1], pts[3*iv.b+2]);
+		glm::dvec3 AB = B - A;
+		double lenSq = glm::dot(AB, AB);
+
+		double maxDist = -1;
+		size_t m = iv.a + 1;
+		for(size_t i = iv.a + 1; i < iv.b; i++){
+			glm::dvec3 P(pts[3*i], pts[3*i+1], pts[3*i+2]);
+			double t = lenSq > 0 ? glm::clamp(glm::dot(P - A, AB)/lenSq, 0.0, 1.0) : 0.0;
+			double dist = glm::length(P - (A + t*AB));
+			if(dist > maxDist){
+				maxDist = dist;
+				m = i;
+			}
+		}
+
+		err[m] = std::min(static_cast<float>(maxDist), iv.parentErr);
+		stack.push_back(Interval {iv.a, m, err[m]});
+		stack.push_back(Interval {m, iv.b, err[m]});
+	}
+
+	std::vector<float> sorted(err);
+	std::sort(sorted.begin(), sorted.end());
+
+	size_t prevCount = n;
+	for(int j = 24; j >= 1; j--){
+		float tol = static_cast<float>(std::ldexp(extent, -j));
+		size_t count = sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), tol);
+		if(count > prevCount/2)
+			continue;
+
+		LineLOD level;
+		level.tolerance = tol;
+		level.firstIndex = ix.size();
+
+		// Vertex v+1 stores point v; vertices 0 and n+1 are the adjacency vertices
+		std::vector<unsigned int> kept;
+		kept.reserve(count);
+		for(size_t i = 0; i < n; i++){
+			if(err[i] > tol)
+				kept.push_back(i + 1);
+		}
+
+		for(size_t k = 0; k + 1 < kept.size(); k++){
+			ix.push_back(k == 0 ? 0 : kept[k-1]);
+			ix.push_back(kept[k]);
+			ix.push_back(kept[k+1]);
+			ix.push_back(k + 2 < kept.size() ? kept[k+2] : n + 1);
+		}
+
+		level.numIndices = ix.size() - level.firstIndex;
+		levels.push_back(level);
+		prevCount = count;
+	}
+}//====================================================
+
 }	// End of gui namespace
 }	// End of astrohelion namespace
 
@@ -0,0 +1,517 @@
+/**
+ *  @file PolylineBatch.cpp
+ *	@brief Draw many lines with a single draw call
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+ 
+/*
+ *	Astrohelion 
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *	
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PolylineBatch.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <glm/glm.hpp>
+
+#include "App.hpp"
+#include "ResourceManager.hpp"
+#include "Shader.hpp"
+
+namespace astrohelion{
+namespace gui{
+
+const unsigned int PolylineBatch::STYLE_TEXELS = 2;
+const unsigned int PolylineBatch::POINT_STRIDE = sizeof(PolylineBatch::BatchVertex)/sizeof(GLfloat);
+
+PolylineBatch::BatchUniforms PolylineBatch::uniforms {};
+
+PolylineBatch::PolylineBatch(){}
+
+//-----------------------------------------------------
+//      Action Functions
+//-----------------------------------------------------
+
+/**
+ *  \brief Add a line to the batch
+ * 
+ *  \param pts Points (in world coordinates) that make up the line
+ *  \param rgba Line color (four elements)
+ *  \param thickness Line thickness, pixels
+ *  \return the ID of the new line, used to modify its style
+ *  \throws std::runtime_error if fewer than two points are provided
+ */
+int PolylineBatch::addLine(const std::vector<float> &pts, const float *rgba, float thickness){
+	return addLine(pts.empty() ? nullptr : &(pts[0]), pts.size()/3, rgba, thickness);
+}//====================================================
+
+/**
+ *  \brief Add a line to the batch
+ *  \details The vertices are laid out as in Polyline: an adjacency vertex
+ *  before the first point, one vertex per point, and an adjacency vertex after
+ *  the last point, with four indices per segment.
+ * 
+ *  \param pts Points (in world coordinates) that make up the line (x, y, z for each point)
+ *  \param n Number of points
+ *  \param rgba Line color (four elements)
+ *  \param thickness Line thickness, pixels
+ *  \return the ID of the new line, used to modify its style
+ *  \throws std::runtime_error if fewer than two points are provided
+ */
+int PolylineBatch::addLine(const float *pts, size_t n, const float *rgba, float thickness){
+	if(!pts || n < 2)
+		throw std::runtime_error("PolylineBatch::addLine: Cannot create a polyline with fewer than two points");
+
+	GLint id = static_cast<GLint>(lines.size());
+	GLuint v0 = static_cast<GLuint>(vertices.size());
+
+	LineRange range;
+	range.firstIndex = indices.size();
+	range.numIndices = static_cast<GLsizei>(4*(n - 1));
+	range.firstVertex = v0;
+	range.numPoints = n;
+	lines.push_back(range);
+
+	glm::vec3 first(pts[0], pts[1], pts[2]);
+	glm::vec3 second(pts[3], pts[4], pts[5]);
+	glm::vec3 adj_pre = first - glm::normalize(second - first);
+
+	glm::vec3 last(pts[3*n-3], pts[3*n-2], pts[3*n-1]);
+	glm::vec3 preLast(pts[3*n-6], pts[3*n-5], pts[3*n-4]);
+	glm::vec3 adj_post = last + glm::normalize(last - preLast);
+
+	vertices.reserve(vertices.size() + n + 2);
+	vertices.push_back(BatchVertex {{adj_pre.x, adj_pre.y, adj_pre.z}, id});
+	for(size_t i = 0; i < n; i++){
+		vertices.push_back(BatchVertex {{pts[3*i+0], pts[3*i+1], pts[3*i+2]}, id});
+	}
+	vertices.push_back(BatchVertex {{adj_post.x, adj_post.y, adj_post.z}, id});
+
+	indices.reserve(indices.size() + 4*(n - 1));
+	for(GLuint i = 0; i < n - 1; i++){
+		indices.push_back(v0 + i);
+		indices.push_back(v0 + i + 1);
+		indices.push_back(v0 + i + 2);
+		indices.push_back(v0 + i + 3);
+	}
+
+	styles.insert(styles.end(), rgba, rgba + 4);
+	styles.push_back(thickness);
+	styles.insert(styles.end(), 3, 0.f);
+	markStyleDirty(id);
+
+	bDrawListDirty = true;
+	return id;
+}//====================================================
+
+/**
+ *  \brief Remove all lines from the batch
+ *  \details The GPU buffers are kept and reused for new lines
+ */
+void PolylineBatch::clear(){
+	vertices.clear();
+	indices.clear();
+	styles.clear();
+	lines.clear();
+	numUploadedVerts = 0;
+	numUploadedIndices = 0;
+	styleDirtyBegin = styleDirtyEnd = 0;
+	bDrawListDirty = true;
+}//====================================================
+
+/**
+ *  \brief Draw every segment of every visible line; see setVisibleRanges()
+ */
+void PolylineBatch::clearVisibleRanges(){
+	for(LineRange &line : lines){
+		line.bCulled = false;
+		line.visibleRanges.clear();
+	}
+	bDrawListDirty = true;
+}//====================================================
+
+/**
+ *  \brief Remove all lines and delete the OpenGL objects owned by the batch
+ *  \details As with Polyline, the objects are not deleted automatically because
+ *  the batch may be copied; call this function from the thread that owns the
+ *  OpenGL context once the batch is no longer needed.
+ */
+void PolylineBatch::destroy(){
+	clear();
+
+	if(VAO != 0){
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		glDeleteBuffers(1, &EBO);
+		glDeleteBuffers(1, &styleBuffer);
+		glDeleteTextures(1, &styleTexture);
+	}
+
+	VAO = VBO = EBO = styleBuffer = styleTexture = 0;
+	vertCapacity = indexCapacity = styleCapacity = 0;
+}//====================================================
+
+/**
+ *  \brief Draw every visible line in the batch
+ *  \details Any pending changes are uploaded first. As with Polyline, the
+ *  camera is read from the Camera uniform block uploaded by the window.
+ */
+void PolylineBatch::draw(){
+	if(lines.empty())
+		return;
+
+	initBuffers();
+	uploadGeometry();
+	uploadStyles();
+	updateDrawList();
+
+	if(drawCounts.empty())
+		return;
+
+	Shader &shader = GLOBAL_APP->getResMan()->getShader("line_batch");
+	resolveUniforms(shader);
+	shader.setFloat(uniforms.miterLimit, miterLimit, true);
+	shader.setInteger(uniforms.lineStyles, 0);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_BUFFER, styleTexture);
+
+	glBindVertexArray(VAO);
+	glMultiDrawElements(GL_LINES_ADJACENCY, &(drawCounts[0]), GL_UNSIGNED_INT,
+		&(drawOffsets[0]), static_cast<GLsizei>(drawCounts.size()));
+	glBindVertexArray(0);
+
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}//====================================================
+
+//-----------------------------------------------------
+//      Set and Get Functions
+//-----------------------------------------------------
+
+/**
+ *  \brief Retrieve the number of lines in the batch
+ *  \return the number of lines in the batch
+ */
+size_t PolylineBatch::getNumLines() const { return lines.size(); }
+
+/**
+ *  \brief Retrieve the total number of points stored in the batch
+ *  \return the total number of points stored in the batch
+ */
+size_t PolylineBatch::getNumPoints() const { return vertices.size() - 2*lines.size(); }
+
+/**
+ *  \brief Retrieve the number of points in a line
+ *  \param id Line ID returned by addLine()
+ *  \return the number of points in the line
+ *  \throws std::out_of_range if the ID is not valid
+ */
+size_t PolylineBatch::getNumPoints(int id) const{
+	checkID(id);
+	return lines[id].numPoints;
+}//====================================================
+
+/**
+ *  \brief Retrieve the number of ranges submitted by draw()
+ *  \details Visible lines that are adjacent in the index buffer are merged
+ *  into a single range, so this is at most getNumLines()
+ *  \return the number of ranges submitted by draw()
+ */
+size_t PolylineBatch::getNumRanges(){
+	updateDrawList();
+	return drawCounts.size();
+}//====================================================
+
+/**
+ *  \brief Retrieve a pointer to the points of a line
+ *  \details The points are stored in the CPU copy of the vertex buffer; the
+ *  position of each point is followed by other vertex data, so consecutive
+ *  points are POINT_STRIDE floats apart. The pointer is invalidated by addLine().
+ * 
+ *  \param id Line ID returned by addLine()
+ *  \return a pointer to the position of the first point of the line
+ *  \throws std::out_of_range if the ID is not valid
+ */
+const float* PolylineBatch::getPointsPtr(int id) const{
+	checkID(id);
+	return vertices[lines[id].firstVertex + 1].pos;
+}//====================================================
+
+/**
+ *  \brief Set the color of a line
+ * 
+ *  \param id Line ID returned by addLine()
+ *  \param r red value, between 0 and 1
+ *  \param g green value, between 0 and 1
+ *  \param b blue value, between 0 and 1
+ *  \param a alpha value, between 0 and 1
+ *  \throws std::out_of_range if the ID is not valid
+ */
+void PolylineBatch::setColor(int id, float r, float g, float b, float a){
+	checkID(id);
+
+	float *pStyle = &(styles[4*STYLE_TEXELS*id]);
+	pStyle[0] = r;
+	pStyle[1] = g;
+	pStyle[2] = b;
+	pStyle[3] = a;
+	markStyleDirty(id);
+}//====================================================
+
+/**
+ *  \brief Set the miter limit applied to every line
+ *  \param limit miter limit; see Polyline
+ */
+void PolylineBatch::setMiterLimit(float limit){ miterLimit = limit; }
+
+/**
+ *  \brief Set the thickness of a line
+ * 
+ *  \param id Line ID returned by addLine()
+ *  \param t Line thickness, pixels
+ *  \throws std::out_of_range if the ID is not valid
+ */
+void PolylineBatch::setThickness(int id, float t){
+	checkID(id);
+
+	styles[4*STYLE_TEXELS*id + 4] = t;
+	markStyleDirty(id);
+}//====================================================
+
+/**
+ *  \brief Limit a line to a set of segment ranges
+ *  \details This is typically the output of SceneBVH::cull() for the current
+ *  view; an empty set hides the line. Ranges of neighboring lines that are
+ *  contiguous in the index buffer are still merged into one draw range.
+ * 
+ *  \param id Line ID returned by addLine()
+ *  \param ranges ordered, non-overlapping ranges of segments to draw
+ *  \throws std::out_of_range if the ID is not valid
+ */
+void PolylineBatch::setVisibleRanges(int id, const std::vector<SegmentRange> &ranges){
+	checkID(id);
+
+	lines[id].visibleRanges = ranges;
+	lines[id].bCulled = true;
+	bDrawListDirty = true;
+}//====================================================
+
+/**
+ *  \brief Set whether or not a line is drawn
+ * 
+ *  \param id Line ID returned by addLine()
+ *  \param bVisible whether or not the line is drawn
+ *  \throws std::out_of_range if the ID is not valid
+ */
+void PolylineBatch::setVisible(int id, bool bVisible){
+	checkID(id);
+
+	if(lines[id].bVisible != bVisible){
+		lines[id].bVisible = bVisible;
+		bDrawListDirty = true;
+	}
+}//====================================================
+
+//-----------------------------------------------------
+//      Utility Functions
+//-----------------------------------------------------
+
+/**
+ *  \brief Check that a line ID is valid
+ *  \param id Line ID
+ *  \throws std::out_of_range if the ID is not valid
+ */
+void PolylineBatch::checkID(int id) const{
+	if(id < 0 || static_cast<size_t>(id) >= lines.size())
+		throw std::out_of_range("PolylineBatch: Line ID is out of range");
+}//====================================================
+
+/**
+ *  \brief Create the OpenGL objects and describe the vertex layout
+ *  \details Nothing is done if the objects already exist
+ */
+void PolylineBatch::initBuffers(){
+	if(VAO != 0)
+		return;
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+	glGenBuffers(1, &styleBuffer);
+	glGenTextures(1, &styleTexture);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+	// Location 0: Position
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (GLvoid*)0);
+	glEnableVertexAttribArray(0);
+
+	// Location 1: Line ID (integer attribute)
+	glVertexAttribIPointer(1, 1, GL_INT, sizeof(BatchVertex), (GLvoid*)(3*sizeof(GLfloat)));
+	glEnableVertexAttribArray(1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);	// Do NOT unbind the EBO; it is stored in the VAO
+}//====================================================
+
+/**
+ *  \brief Flag the style of a line for upload
+ *  \param id Line ID
+ */
+void PolylineBatch::markStyleDirty(int id){
+	size_t ix = static_cast<size_t>(id);
+	if(styleDirtyBegin == styleDirtyEnd){
+		styleDirtyBegin = ix;
+		styleDirtyEnd = ix + 1;
+	}else{
+		styleDirtyBegin = std::min(styleDirtyBegin, ix);
+		styleDirtyEnd = std::max(styleDirtyEnd, ix + 1);
+	}
+}//====================================================
+
+/**
+ *  \brief Look up the uniform locations of the "line_batch" shader
+ *  \details Nothing is done if the locations were already resolved for the
+ *  program currently stored in the shader
+ * 
+ *  \param shader the "line_batch" shader
+ */
+void PolylineBatch::resolveUniforms(Shader &shader){
+	if(uniforms.program == shader.getID())
+		return;
+
+	uniforms.program = shader.getID();
+	uniforms.miterLimit = shader.getUniformLocation("miterLimit");
+	uniforms.lineStyles = shader.getUniformLocation("lineStyles");
+}//====================================================
+
+/**
+ *  \brief Rebuild the ranges passed to glMultiDrawElements()
+ *  \details Ranges that are contiguous in the index buffer (consecutive
+ *  visible lines, or consecutive visible segment ranges) are merged into one
+ *  range; each segment carries its own adjacency indices, so no segment joins
+ *  two lines.
+ */
+void PolylineBatch::updateDrawList(){
+	if(!bDrawListDirty)
+		return;
+
+	drawCounts.clear();
+	drawOffsets.clear();
+
+	size_t prevEnd = 0;		// One past the last index of the previous range
+	for(const LineRange &line : lines){
+		if(!line.bVisible)
+			continue;
+
+		std::vector<SegmentRange> all;
+		if(!line.bCulled)
+			all.push_back(SegmentRange(0, line.numPoints - 1));
+
+		for(const SegmentRange &range : line.bCulled ? line.visibleRanges : all){
+			if(range.first >= line.numPoints - 1 || range.count == 0)
+				continue;
+
+			size_t first = line.firstIndex + 4*range.first;
+			GLsizei count = static_cast<GLsizei>(4*std::min(range.count, line.numPoints - 1 - range.first));
+			if(!drawCounts.empty() && first == prevEnd){
+				drawCounts.back() += count;
+			}else{
+				drawCounts.push_back(count);
+				drawOffsets.push_back(reinterpret_cast<const GLvoid*>(first*sizeof(GLuint)));
+			}
+			prevEnd = first + count;
+		}
+	}
+
+	bDrawListDirty = false;
+}//====================================================
+
+/**
+ *  \brief Copy new vertices and indices to the GPU
+ *  \details Only data added since the previous upload are copied. The buffers
+ *  are grown geometrically so that adding lines one at a time costs O(1)
+ *  amortized uploads per line.
+ */
+void PolylineBatch::uploadGeometry(){
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+	if(vertices.size() > vertCapacity){
+		vertCapacity = std::max(vertices.size(), 2*vertCapacity);
+		glBufferData(GL_ARRAY_BUFFER, vertCapacity*sizeof(BatchVertex), nullptr, GL_DYNAMIC_DRAW);
+		numUploadedVerts = 0;
+	}
+	if(vertices.size() > numUploadedVerts){
+		glBufferSubData(GL_ARRAY_BUFFER, numUploadedVerts*sizeof(BatchVertex),
+			(vertices.size() - numUploadedVerts)*sizeof(BatchVertex), &(vertices[numUploadedVerts]));
+		numUploadedVerts = vertices.size();
+	}
+
+	if(indices.size() > indexCapacity){
+		indexCapacity = std::max(indices.size(), 2*indexCapacity);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity*sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+		numUploadedIndices = 0;
+	}
+	if(indices.size() > numUploadedIndices){
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, numUploadedIndices*sizeof(GLuint),
+			(indices.size() - numUploadedIndices)*sizeof(GLuint), &(indices[numUploadedIndices]));
+		numUploadedIndices = indices.size();
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}//====================================================
+
+/**
+ *  \brief Copy modified line styles to the GPU
+ */
+void PolylineBatch::uploadStyles(){
+	if(styleDirtyBegin == styleDirtyEnd)
+		return;
+
+	const size_t lineFloats = 4*STYLE_TEXELS;
+	glBindBuffer(GL_TEXTURE_BUFFER, styleBuffer);
+	if(lines.size() > styleCapacity){
+		styleCapacity = std::max(lines.size(), 2*styleCapacity);
+		glBufferData(GL_TEXTURE_BUFFER, styleCapacity*lineFloats*sizeof(GLfloat), nullptr, GL_DYNAMIC_DRAW);
+		styleDirtyBegin = 0;
+		styleDirtyEnd = lines.size();
+
+		// Reattach the (new) storage to the buffer texture
+		glBindTexture(GL_TEXTURE_BUFFER, styleTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, styleBuffer);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+
+	glBufferSubData(GL_TEXTURE_BUFFER, styleDirtyBegin*lineFloats*sizeof(GLfloat),
+		(styleDirtyEnd - styleDirtyBegin)*lineFloats*sizeof(GLfloat), &(styles[styleDirtyBegin*lineFloats]));
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	styleDirtyBegin = styleDirtyEnd = 0;
+}//====================================================
+
+}	// End of gui namespace
+}	// End of astrohelion namespace
@@ -0,0 +1,128 @@
+/**
+ *  @file Quantize.cpp
+ *	@brief Compact, relative-origin encoding of vertex positions
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+
+/*
+ *	Astrohelion
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Quantize.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace astrohelion{
+namespace gui{
+
+/** Largest value of a quantized coordinate */
+static const float QUANT_MAX = 65535.f;
+
+/** Largest number of chunks that can be addressed by a 16-bit chunk index */
+static const size_t QUANT_MAX_CHUNKS = 65536;
+
+//-----------------------------------------------------
+//      Function Definitions
+//-----------------------------------------------------
+
+/**
+ *  @brief Encode positions as 16-bit offsets relative to per-chunk origins
+ *  @details The positions are split into chunks of consecutive positions. Each
+ *  chunk stores the minimum corner (origin) and size (scale) of its bounding box
+ *  in the chunk table; each position stores its offset within that box as three
+ *  normalized unsigned shorts, followed by the index of its chunk. A position is
+ *  recovered as <tt>origin + scale*q/65535</tt>, which is exactly what OpenGL
+ *  computes for a normalized GL_UNSIGNED_SHORT attribute. The error of each
+ *  coordinate is at most half of <tt>scale/65535</tt>, so shorter chunks are more
+ *  accurate but need a larger table.
+ *
+ *  The chunk size is enlarged if the positions would otherwise require more
+ *  chunks than a 16-bit index can address.
+ *
+ *  @param pts positions (x, y, z for each position)
+ *  @param n number of positions
+ *  @param chunkSize number of consecutive positions that share an origin and scale
+ *  @param q Receives QUANT_STRIDE values per position; any previous contents are discarded
+ *  @param chunks Receives QUANT_CHUNK_STRIDE values per chunk; any previous contents
+ *  are discarded
+ */
+void quantizePositions(const float *pts, size_t n, size_t chunkSize, std::vector<unsigned short> &q,
+	std::vector<float> &chunks){
+
+	q.clear();
+	chunks.clear();
+	if(!pts || n == 0)
+		return;
+
+	chunkSize = std::max(chunkSize, (n + QUANT_MAX_CHUNKS - 1)/QUANT_MAX_CHUNKS);
+	size_t numChunks = (n + chunkSize - 1)/chunkSize;
+
+	q.resize(QUANT_STRIDE*n);
+	chunks.resize(QUANT_CHUNK_STRIDE*numChunks, 0.f);
+
+	for(size_t c = 0; c < numChunks; c++){
+		size_t first = c*chunkSize;
+		size_t last = std::min(n, first + chunkSize);
+
+		glm::vec3 lo(pts[3*first], pts[3*first+1], pts[3*first+2]), hi = lo;
+		for(size_t i = first + 1; i < last; i++){
+			glm::vec3 p(pts[3*i], pts[3*i+1], pts[3*i+2]);
+			lo = glm::min(lo, p);
+			hi = glm::max(hi, p);
+		}
+		glm::vec3 scale = hi - lo;
+
+		float *pChunk = &(chunks[QUANT_CHUNK_STRIDE*c]);
+		pChunk[0] = lo.x;
+		pChunk[1] = lo.y;
+		pChunk[2] = lo.z;
+		pChunk[4] = scale.x;
+		pChunk[5] = scale.y;
+		pChunk[6] = scale.z;
+
+		for(size_t i = first; i < last; i++){
+			for(int k = 0; k < 3; k++){
+				// A flat chunk (scale = 0) decodes to its origin regardless of the offset
+				float t = scale[k] > 0 ? (pts[3*i+k] - lo[k])/scale[k] : 0.f;
+				q[QUANT_STRIDE*i + k] = static_cast<unsigned short>(std::lround(glm::clamp(t, 0.f, 1.f)*QUANT_MAX));
+			}
+			q[QUANT_STRIDE*i + 3] = static_cast<unsigned short>(c);
+		}
+	}
+}//====================================================
+
+/**
+ *  @brief Decode a position encoded by quantizePositions()
+ *
+ *  @param q pointer to the QUANT_STRIDE values that describe the position
+ *  @param chunks chunk table produced by quantizePositions()
+ *  @return the position, world coordinates
+ */
+glm::vec3 dequantizePosition(const unsigned short *q, const float *chunks){
+	const float *pChunk = chunks + QUANT_CHUNK_STRIDE*q[3];
+	return glm::vec3(pChunk[0], pChunk[1], pChunk[2]) +
+		glm::vec3(pChunk[4], pChunk[5], pChunk[6])*glm::vec3(q[0], q[1], q[2])/QUANT_MAX;
+}//====================================================
+
+}	// End of gui namespace
+}	// End of astrohelion namespace
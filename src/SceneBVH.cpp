@@ -0,0 +1,312 @@
+/**
+ *  @file SceneBVH.cpp
+ *	@brief Bounding volume hierarchy of line chunks for frustum culling
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+
+/*
+ *	Astrohelion
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SceneBVH.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace astrohelion{
+namespace gui{
+
+const size_t SceneBVH::DEFAULT_CHUNK_SIZE = 256;
+
+/** Maximum number of chunks stored in a leaf node */
+static const size_t BVH_LEAF_SIZE = 4;
+
+//-----------------------------------------------------
+//      *structors
+//-----------------------------------------------------
+
+/**
+ *  @brief Construct an empty index
+ */
+SceneBVH::SceneBVH(){}
+
+//-----------------------------------------------------
+//      Action Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Split a line into chunks and add them to the index
+ *  @details The hierarchy is rebuilt by the next call to build() or cull()
+ * 
+ *  @param pts points that make up the line; the first three floats of each
+ *  point are its position, world coordinates
+ *  @param n number of points
+ *  @param stride number of floats between the starts of consecutive points
+ *  @param chunkSize number of segments in each chunk; smaller chunks cull more
+ *  precisely but make cull() slower
+ *  @return the ID of the line, used to retrieve its visible ranges
+ *  @throws std::runtime_error if the points do not form a line
+ */
+int SceneBVH::addLine(const float *pts, size_t n, size_t stride, size_t chunkSize){
+	if(!pts || n < 2 || stride < 3)
+		throw std::runtime_error("SceneBVH::addLine: Points do not describe a line");
+
+	if(chunkSize == 0)
+		chunkSize = 1;
+
+	int id = static_cast<int>(visibleRanges.size());
+	visibleRanges.push_back(std::vector<SegmentRange>());
+
+	size_t numSegs = n - 1;
+	for(size_t first = 0; first < numSegs; first += chunkSize){
+		Chunk chunk;
+		chunk.line = id;
+		chunk.segments = SegmentRange(first, std::min(chunkSize, numSegs - first));
+
+		// The chunk contains both endpoints of each of its segments
+		const float *p = pts + stride*first;
+		chunk.lo = chunk.hi = glm::vec3(p[0], p[1], p[2]);
+		for(size_t i = first + 1; i <= first + chunk.segments.count; i++){
+			p = pts + stride*i;
+			glm::vec3 pos(p[0], p[1], p[2]);
+			chunk.lo = glm::min(chunk.lo, pos);
+			chunk.hi = glm::max(chunk.hi, pos);
+		}
+		chunks.push_back(chunk);
+	}
+
+	numSegments += numSegs;
+	bBuilt = false;
+	return id;
+}//====================================================
+
+/**
+ *  @brief Build the hierarchy from the chunks that have been added
+ *  @details Nodes are split at the median chunk along the longest axis of
+ *  the chunk centers. This is called automatically by cull() if needed.
+ */
+void SceneBVH::build(){
+	nodes.clear();
+	order.resize(chunks.size());
+	for(size_t i = 0; i < order.size(); i++){
+		order[i] = i;
+	}
+
+	if(!chunks.empty()){
+		nodes.reserve(2*chunks.size()/BVH_LEAF_SIZE + 1);
+		buildNode(0, chunks.size());
+	}
+
+	visible.assign(chunks.size(), 0);
+	bBuilt = true;
+}//====================================================
+
+/**
+ *  @brief Remove every line from the index
+ */
+void SceneBVH::clear(){
+	chunks.clear();
+	order.clear();
+	nodes.clear();
+	visible.clear();
+	visibleRanges.clear();
+	numSegments = 0;
+	numVisibleChunks = 0;
+	numVisibleSegments = 0;
+	bBuilt = false;
+}//====================================================
+
+/**
+ *  @brief Determine which chunks may be visible within a view frustum
+ *  @details Subtrees whose boxes are outside the frustum are skipped, and
+ *  subtrees whose boxes are entirely inside it are accepted without testing
+ *  their chunks. The visible chunks of each line are then merged into as few
+ *  segment ranges as possible; see getVisibleRanges().
+ * 
+ *  @param frustum view frustum, world coordinates (e.g., from CameraFPS::getFrustum())
+ */
+void SceneBVH::cull(const Frustum &frustum){
+	if(!bBuilt)
+		build();
+
+	std::fill(visible.begin(), visible.end(), 0);
+
+	std::vector<int> stack;
+	if(!nodes.empty())
+		stack.push_back(0);
+
+	while(!stack.empty()){
+		const Node &node = nodes[stack.back()];
+		stack.pop_back();
+
+		if(!frustum.intersects(node.lo, node.hi))
+			continue;
+
+		if(frustum.contains(node.lo, node.hi)){
+			markVisible(node.first, node.count);
+		}else if(node.left < 0){
+			for(size_t i = node.first; i < node.first + node.count; i++){
+				const Chunk &chunk = chunks[order[i]];
+				if(frustum.intersects(chunk.lo, chunk.hi))
+					visible[order[i]] = 1;
+			}
+		}else{
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+
+	// Chunks are stored in line order, so adjacent visible chunks merge into one range
+	for(std::vector<SegmentRange> &ranges : visibleRanges){
+		ranges.clear();
+	}
+	numVisibleChunks = 0;
+	numVisibleSegments = 0;
+
+	for(size_t c = 0; c < chunks.size(); c++){
+		if(!visible[c])
+			continue;
+
+		const SegmentRange &segs = chunks[c].segments;
+		std::vector<SegmentRange> &ranges = visibleRanges[chunks[c].line];
+		if(!ranges.empty() && ranges.back().first + ranges.back().count == segs.first)
+			ranges.back().count += segs.count;
+		else
+			ranges.push_back(segs);
+
+		numVisibleChunks++;
+		numVisibleSegments += segs.count;
+	}
+}//====================================================
+
+//-----------------------------------------------------
+//      Set and Get Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Retrieve the number of chunks in the index
+ *  @return the number of chunks in the index
+ */
+size_t SceneBVH::getNumChunks() const { return chunks.size(); }
+
+/**
+ *  @brief Retrieve the number of lines in the index
+ *  @return the number of lines in the index
+ */
+size_t SceneBVH::getNumLines() const { return visibleRanges.size(); }
+
+/**
+ *  @brief Retrieve the total number of segments in every line
+ *  @return the total number of segments in every line
+ */
+size_t SceneBVH::getNumSegments() const { return numSegments; }
+
+/**
+ *  @brief Retrieve the number of chunks that passed the most recent cull()
+ *  @return the number of chunks that passed the most recent cull()
+ */
+size_t SceneBVH::getNumVisibleChunks() const { return numVisibleChunks; }
+
+/**
+ *  @brief Retrieve the number of segments that passed the most recent cull()
+ *  @return the number of segments that passed the most recent cull()
+ */
+size_t SceneBVH::getNumVisibleSegments() const { return numVisibleSegments; }
+
+/**
+ *  @brief Retrieve the segments of a line that passed the most recent cull()
+ * 
+ *  @param id line ID returned by addLine()
+ *  @return the visible segment ranges, ordered and non-overlapping
+ *  @throws std::out_of_range if the ID is not valid
+ */
+const std::vector<SegmentRange>& SceneBVH::getVisibleRanges(int id) const{
+	if(id < 0 || static_cast<size_t>(id) >= visibleRanges.size())
+		throw std::out_of_range("SceneBVH::getVisibleRanges: Line ID is out of range");
+
+	return visibleRanges[id];
+}//====================================================
+
+//-----------------------------------------------------
+//      Utility Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Create a node for a range of the order array and, recursively, its children
+ * 
+ *  @param first index of the first chunk of the node in order
+ *  @param count number of chunks in the node
+ *  @return the index of the new node
+ */
+int SceneBVH::buildNode(size_t first, size_t count){
+	int ix = static_cast<int>(nodes.size());
+	nodes.push_back(Node());
+
+	Node node;
+	node.first = first;
+	node.count = count;
+	node.lo = chunks[order[first]].lo;
+	node.hi = chunks[order[first]].hi;
+
+	glm::vec3 cLo = 0.5f*(node.lo + node.hi), cHi = cLo;
+	for(size_t i = first + 1; i < first + count; i++){
+		const Chunk &chunk = chunks[order[i]];
+		node.lo = glm::min(node.lo, chunk.lo);
+		node.hi = glm::max(node.hi, chunk.hi);
+
+		glm::vec3 center = 0.5f*(chunk.lo + chunk.hi);
+		cLo = glm::min(cLo, center);
+		cHi = glm::max(cHi, center);
+	}
+
+	if(count > BVH_LEAF_SIZE){
+		glm::vec3 extent = cHi - cLo;
+		int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+		std::vector<size_t>::iterator itFirst = order.begin() + first;
+		std::vector<size_t>::iterator itMid = itFirst + count/2;
+		std::nth_element(itFirst, itMid, itFirst + count, [this, axis](size_t a, size_t b){
+			return chunks[a].lo[axis] + chunks[a].hi[axis] < chunks[b].lo[axis] + chunks[b].hi[axis];
+		});
+
+		node.left = buildNode(first, count/2);
+		node.right = buildNode(first + count/2, count - count/2);
+	}
+
+	nodes[ix] = node;
+	return ix;
+}//====================================================
+
+/**
+ *  @brief Mark a range of the order array as visible
+ * 
+ *  @param first index of the first chunk in order
+ *  @param count number of chunks
+ */
+void SceneBVH::markVisible(size_t first, size_t count){
+	for(size_t i = first; i < first + count; i++){
+		visible[order[i]] = 1;
+	}
+}//====================================================
+
+}// End of gui namespace
+}// End of astrohelion namespace
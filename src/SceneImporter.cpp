@@ -0,0 +1,428 @@
+/**
+ *  @file SceneImporter.cpp
+ *	@brief Import many trajectories in parallel
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+ 
+/*
+ *	Astrohelion 
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *	
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SceneImporter.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+
+#ifndef _WIN32
+	#include <dirent.h>
+#endif
+
+#include "Polyline.hpp"
+#include "PolylineBatch.hpp"
+#include "TrajCache.hpp"
+
+#include "astrohelion/SysData_bc4bp.hpp"
+#include "astrohelion/Traj_bc4bp.hpp"
+
+namespace astrohelion{
+namespace gui{
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ *  @brief Compute the number of seconds elapsed since a time point
+ *  @param t0 time point
+ *  @return the number of seconds elapsed since <tt>t0</tt>
+ */
+static double secondsSince(Clock::time_point t0){
+	return std::chrono::duration<double>(Clock::now() - t0).count();
+}//====================================================
+
+//-----------------------------------------------------
+//      *structors
+//-----------------------------------------------------
+
+/**
+ *  @brief Construct a default importer; no threads are started
+ */
+SceneImporter::SceneImporter() : nextFile(0), numParsed(0), bAbort(false) {}
+
+/**
+ *  @brief Destruct the importer, stopping the worker threads if they are running
+ */
+SceneImporter::~SceneImporter(){
+	stop();
+}//====================================================
+
+//-----------------------------------------------------
+//      Action Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Begin importing a set of trajectory files
+ *  @details Any import that is already in progress is stopped and its
+ *  results are discarded.
+ * 
+ *  @param files filepaths to the trajectory files; the lines are delivered
+ *  by uploadReady() in this order
+ *  @param numThreads number of worker threads; zero selects the hardware concurrency
+ */
+void SceneImporter::start(const std::vector<std::string> &files, unsigned int numThreads){
+	stop();
+
+	arcs.clear();
+	arcs.resize(files.size());
+	for(size_t i = 0; i < files.size(); i++){
+		arcs[i].filepath = files[i];
+	}
+
+	bReady.assign(files.size(), false);
+	nextFile = 0;
+	numParsed = 0;
+	numUploaded = 0;
+	bQueued = false;
+	totalTime = 0;
+	bAbort = false;
+	startTime = Clock::now();
+
+	if(numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	numThreads = std::min(numThreads, static_cast<unsigned int>(std::max<size_t>(1, files.size())));
+	for(unsigned int t = 0; t < numThreads; t++){
+		workers.push_back(std::thread(&SceneImporter::work, this));
+	}
+}//====================================================
+
+/**
+ *  @brief Stop the worker threads and wait for them to exit
+ *  @details Each worker finishes the file it is currently importing first
+ */
+void SceneImporter::stop(){
+	bAbort = true;
+	for(auto &w : workers){
+		if(w.joinable())
+			w.join();
+	}
+	workers.clear();
+}//====================================================
+
+/**
+ *  @brief Upload the lines that are ready, in file order
+ *  @details Upload stops at the first file that has not been processed yet so
+ *  that the lines always appear in the order the files were given. Files that
+ *  could not be imported produce an empty Polyline so that the indices of
+ *  <tt>lines</tt> and getArcs() always match.
+ *  
+ *  This function must be called from the thread that owns the OpenGL context.
+ * 
+ *  @param lines vector of lines to append the uploaded lines to
+ *  @param maxSeconds Upload stops once this much time has been spent; set to zero
+ *  to upload every ready line
+ *  @return the number of lines uploaded during this call
+ */
+size_t SceneImporter::uploadReady(std::vector<Polyline> &lines, double maxSeconds){
+	if(lines.capacity() < lines.size() + arcs.size() - numUploaded)
+		lines.reserve(lines.size() + arcs.size() - numUploaded);
+
+	return uploadArcs([&lines](SceneArc &arc){
+		lines.push_back(Polyline());
+		if(!arc.error.empty())
+			return;
+
+		if(arc.pCache)
+			lines.back().createFromCache(arc.pCache);
+		else
+			lines.back().createFromData(arc.vertices);
+	}, maxSeconds);
+}//====================================================
+
+/**
+ *  @brief Add the lines that are ready to a batch, in file order
+ *  @details Files that could not be imported are skipped. The batch uploads
+ *  the new lines to the GPU the next time it is drawn.
+ * 
+ *  @param batch batch to add the lines to
+ *  @param maxSeconds Processing stops once this much time has been spent; set
+ *  to zero to process every ready line
+ *  @return the number of arcs processed during this call
+ */
+size_t SceneImporter::uploadReady(PolylineBatch &batch, double maxSeconds){
+	bQueued = true;
+	return uploadArcs([&batch](SceneArc &arc){
+		if(!arc.error.empty())
+			return;
+
+		if(arc.pCache){
+			batch.addLine(arc.pCache->getPoints(), arc.pCache->getNumPoints());
+		}else{
+			// The points follow the leading adjacency vertex
+			batch.addLine(&(arc.vertices[Polyline::VERTEX_STRIDE]), arc.vertices.size()/Polyline::VERTEX_STRIDE - 2);
+		}
+
+		// The batch stores its own copy of the geometry
+		std::vector<float>().swap(arc.vertices);
+	}, maxSeconds);
+}//====================================================
+
+/**
+ *  @brief Pass each arc that is ready to an upload function, in file order
+ * 
+ *  @param upload function that uploads one arc; exceptions it throws are
+ *  recorded as the arc's error
+ *  @param maxSeconds Upload stops once this much time has been spent; set to zero
+ *  to upload every ready arc
+ *  @return the number of arcs uploaded during this call
+ */
+size_t SceneImporter::uploadArcs(const std::function<void (SceneArc&)> &upload, double maxSeconds){
+	Clock::time_point t0 = Clock::now();
+
+	size_t count = 0;
+	while(numUploaded < arcs.size()){
+		{
+			std::lock_guard<std::mutex> lock(readyMutex);
+			if(!bReady[numUploaded])
+				break;
+		}
+
+		SceneArc &arc = arcs[numUploaded];
+		Clock::time_point tUp = Clock::now();
+
+		try{
+			upload(arc);
+		}catch(std::exception &e){
+			arc.error = e.what();
+		}
+
+		arc.pCache.reset();
+		arc.uploadTime = secondsSince(tUp);
+		numUploaded++;
+		count++;
+
+		if(numUploaded == arcs.size())
+			totalTime = secondsSince(startTime);
+
+		if(maxSeconds > 0 && secondsSince(t0) > maxSeconds)
+			break;
+	}
+
+	return count;
+}//====================================================
+
+/**
+ *  @brief Print the parse and upload timing of each file to standard output
+ *  @details When the arcs were added to a PolylineBatch, the batch uploads
+ *  them when it is drawn, so the second column is reported as "queue" and
+ *  only covers the copy into the batch
+ */
+void SceneImporter::printReport() const{
+	const char *stage = bQueued ? "queue" : "upload";
+	double sumParse = 0, sumUpload = 0;
+	printf("Scene import report (%zu files, %zu workers)\n", arcs.size(), workers.size());
+	printf("  %10s  %6s (ms)  %5s  %s\n", "parse (ms)", stage, "cache", "file");
+	for(size_t i = 0; i < numUploaded; i++){
+		const SceneArc &arc = arcs[i];
+		printf("  %10.2f  %11.2f  %5s  %s%s%s\n", 1000*arc.parseTime, 1000*arc.uploadTime,
+			arc.bFromCache ? "yes" : "no", arc.filepath.c_str(),
+			arc.error.empty() ? "" : " -- ERROR: ", arc.error.c_str());
+		sumParse += arc.parseTime;
+		sumUpload += arc.uploadTime;
+	}
+	printf("  Total parse = %.2f ms, total %s = %.2f ms, wall time = %.2f ms\n",
+		1000*sumParse, stage, 1000*sumUpload, 1000*getElapsedTime());
+}//====================================================
+
+//-----------------------------------------------------
+//      Set and Get Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Retrieve the number of files being imported
+ *  @return the number of files being imported
+ */
+size_t SceneImporter::getNumFiles() const { return arcs.size(); }
+
+/**
+ *  @brief Retrieve the number of files processed by the worker threads
+ *  @return the number of files processed by the worker threads
+ */
+size_t SceneImporter::getNumParsed() const { return numParsed; }
+
+/**
+ *  @brief Retrieve the number of lines uploaded to the GPU
+ *  @return the number of lines uploaded to the GPU
+ */
+size_t SceneImporter::getNumUploaded() const { return numUploaded; }
+
+/**
+ *  @brief Retrieve the wall-clock time spent on the import
+ *  @return the time between start() and the final upload, or the time
+ *  since start() if the import is still in progress, seconds
+ */
+double SceneImporter::getElapsedTime() const{
+	if(arcs.empty())
+		return 0;
+
+	return isFinished() ? totalTime : secondsSince(startTime);
+}//====================================================
+
+/**
+ *  @brief Retrieve the imported arcs
+ *  @details Only the first getNumUploaded() entries may be read safely
+ *  while the import is in progress
+ *  @return a reference to the vector of imported arcs
+ */
+const std::vector<SceneArc>& SceneImporter::getArcs() const { return arcs; }
+
+/**
+ *  @brief Determine whether every file has been imported and uploaded
+ *  @return whether every file has been imported and uploaded
+ */
+bool SceneImporter::isFinished() const { return numUploaded == arcs.size(); }
+
+/**
+ *  @brief Set whether or not trajectory caches are read and written
+ *  @details This setting applies to imports started after it is changed
+ *  @param b whether or not trajectory caches are read and written
+ */
+void SceneImporter::setUseCache(bool b){ bUseCache = b; }
+
+/**
+ *  @brief List the files in a directory that have a given extension
+ * 
+ *  @param dir path to the directory
+ *  @param ext file extension, including the period
+ *  @return sorted filepaths of the matching files
+ *  @throws std::runtime_error if the directory cannot be read
+ */
+std::vector<std::string> SceneImporter::listDirectory(const char* dir, const char* ext){
+	std::vector<std::string> files;
+
+#ifndef _WIN32
+	DIR *pDir = opendir(dir);
+	if(!pDir)
+		throw std::runtime_error("SceneImporter::listDirectory: Could not open directory");
+
+	std::string base(dir);
+	if(!base.empty() && base.back() != '/')
+		base += '/';
+
+	size_t extLen = strlen(ext);
+	while(struct dirent *pEntry = readdir(pDir)){
+		std::string name(pEntry->d_name);
+		if(name.size() > extLen && name.compare(name.size() - extLen, extLen, ext) == 0)
+			files.push_back(base + name);
+	}
+	closedir(pDir);
+#else
+	(void) dir;
+	(void) ext;
+	throw std::runtime_error("SceneImporter::listDirectory: Not implemented on this platform");
+#endif
+
+	std::sort(files.begin(), files.end());
+	return files;
+}//====================================================
+
+//-----------------------------------------------------
+//      Utility Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Worker thread function: import files until none remain
+ */
+void SceneImporter::work(){
+	while(!bAbort){
+		size_t ix = nextFile++;
+		if(ix >= arcs.size())
+			break;
+
+		importArc(arcs[ix]);
+
+		{
+			std::lock_guard<std::mutex> lock(readyMutex);
+			bReady[ix] = true;
+		}
+		numParsed++;
+	}
+}//====================================================
+
+/**
+ *  @brief Read one trajectory file and build its vertex data
+ *  @details A valid cache is mapped in place of parsing the file; otherwise,
+ *  the file is parsed and a cache is written for subsequent imports. Files
+ *  are read one at a time (see getTrajReadMutex()); extraction, the vertex
+ *  data, and the cache write run in parallel. Errors are recorded in
+ *  SceneArc::error rather than thrown.
+ * 
+ *  @param arc arc to import; SceneArc::filepath must be set
+ */
+void SceneImporter::importArc(SceneArc &arc){
+	Clock::time_point t0 = Clock::now();
+	const char *path = arc.filepath.c_str();
+	std::string cachePath = TrajCache::getCachePath(path);
+
+	try{
+		std::shared_ptr<TrajCache> cache(new TrajCache());
+		if(bUseCache && cache->open(cachePath.c_str(), path)){
+			int n = static_cast<int>(cache->getNumPoints());
+			appendMarkers(cache->getPoints(), 0, n, n, &arc.markers);
+			arc.pCache = cache;
+			arc.bFromCache = true;
+		}else{
+			// The file readers are not reentrant; only one file is read at a time
+			std::unique_ptr<SysData_bc4bp> pSys;
+			std::unique_ptr<Traj_bc4bp> pTraj;
+			{
+				std::lock_guard<std::mutex> lock(getTrajReadMutex());
+				pSys.reset(new SysData_bc4bp(path));
+				pTraj.reset(new Traj_bc4bp(path, pSys.get()));
+			}
+
+			// Files are already processed in parallel; extract each one on a single thread
+			std::vector<float> pts;
+			extractPositions(*pTraj, pts, &arc.markers, 1);
+			Polyline::buildVertexData(pts, arc.vertices);
+
+			if(bUseCache){
+				try{
+					std::vector<double> epochs;
+					extractEpochs(*pTraj, epochs);
+					TrajCache::writeVertices(cachePath.c_str(), path, arc.vertices, epochs);
+				}catch(std::exception &e){
+					printf("SceneImporter: Could not write trajectory cache for %s: %s\n", path, e.what());
+				}
+			}
+		}
+	}catch(std::exception &e){
+		arc.error = e.what();
+		arc.vertices.clear();
+	}
+
+	arc.parseTime = secondsSince(t0);
+}//====================================================
+
+}// End of gui namespace
+}// End of astrohelion namespace
@@ -30,6 +30,9 @@
 
 #include "Shader.hpp"
 
+#include <algorithm>
+#include <vector>
+
 #include <glm/gtc/matrix_transform.hpp>
 #include "glm/gtc/type_ptr.hpp"
 
@@ -95,18 +98,76 @@ void Shader::compile(const GLchar* vertexSource, const GLchar* fragmentSource, c
     
     if (geometrySource != nullptr)
         glDeleteShader(gShader);
+
+    reflect();
+
+    // Every shader reads the camera from the buffer bound to the same point
+    GLuint cameraBlock = glGetUniformBlockIndex(id, "Camera");
+    if(cameraBlock != GL_INVALID_INDEX)
+        glUniformBlockBinding(id, cameraBlock, CAMERA_BLOCK_BINDING);
 }//====================================================
 
 //-----------------------------------------------------
 //      Set and Get Functions
 //-----------------------------------------------------
 
+/**
+ *  @brief Retrieve the location of a vertex attribute
+ *  @param name attribute name
+ *  @return the location of the attribute, or -1 if it is not active
+ */
+GLint Shader::getAttribLocation(const GLchar *name) const{
+    std::unordered_map<std::string, ShaderVariable>::const_iterator it = attributes.find(name);
+    return it == attributes.end() ? -1 : it->second.location;
+}//====================================================
+
+/**
+ *  @brief Retrieve every active vertex attribute
+ *  @return the active attributes, by name
+ */
+const std::unordered_map<std::string, ShaderVariable>& Shader::getAttributes() const { return attributes; }
+
 /**
  *  @brief Retrieve the shader program ID
  *  @return the shader program ID
  */
 GLuint Shader::getID() const { return id; }
 
+/**
+ *  @brief Retrieve the location of a uniform
+ *  @details The location can be passed to the set functions in place of
+ *  the name; it does not change until the shader is compiled again. A
+ *  warning is printed the first time an inactive uniform is requested.
+ * 
+ *  @param name uniform name
+ *  @return the location of the uniform, or -1 if it is not active (setting
+ *  a uniform at location -1 has no effect)
+ */
+GLint Shader::getUniformLocation(const GLchar *name){
+    std::unordered_map<std::string, ShaderVariable>::const_iterator it = uniforms.find(name);
+    if(it != uniforms.end())
+        return it->second.location;
+
+    if(warnedUniforms.insert(name).second){
+        std::cout << "| WARNING::SHADER: Uniform \"" << name << "\" is not active in program " << id
+            << "; it will not be set" << std::endl;
+    }
+    return -1;
+}//====================================================
+
+/**
+ *  @brief Retrieve every active uniform
+ *  @return the active uniforms, by name
+ */
+const std::unordered_map<std::string, ShaderVariable>& Shader::getUniforms() const { return uniforms; }
+
+/**
+ *  @brief Determine whether a uniform is active
+ *  @param name uniform name
+ *  @return whether the uniform is active in the program
+ */
+bool Shader::hasUniform(const GLchar *name) const { return uniforms.count(name) > 0; }
+
 //-----------------------------------------------------
 //      Utility Functions
 //-----------------------------------------------------
@@ -114,55 +175,109 @@ GLuint Shader::getID() const { return id; }
 void Shader::setFloat(const GLchar *name, GLfloat value, GLboolean useShader){
     if (useShader)
         use();
-    glUniform1f(glGetUniformLocation(id, name), value);
+    glUniform1f(getUniformLocation(name), value);
 }//====================================================
 
 void Shader::setInteger(const GLchar *name, GLint value, GLboolean useShader){
     if (useShader)
         use();
-    glUniform1i(glGetUniformLocation(id, name), value);
+    glUniform1i(getUniformLocation(name), value);
 }//====================================================
 
 void Shader::setVector2f(const GLchar *name, GLfloat x, GLfloat y, GLboolean useShader){
     if (useShader)
         use();
-    glUniform2f(glGetUniformLocation(id, name), x, y);
+    glUniform2f(getUniformLocation(name), x, y);
 }//====================================================
 
 void Shader::setVector2f(const GLchar *name, const glm::vec2 &value, GLboolean useShader){
     if (useShader)
         use();
-    glUniform2f(glGetUniformLocation(id, name), value.x, value.y);
+    glUniform2f(getUniformLocation(name), value.x, value.y);
 }//====================================================
 
 void Shader::setVector3f(const GLchar *name, GLfloat x, GLfloat y, GLfloat z, GLboolean useShader){
     if (useShader)
         use();
-    glUniform3f(glGetUniformLocation(id, name), x, y, z);
+    glUniform3f(getUniformLocation(name), x, y, z);
 }//====================================================
 
 void Shader::setVector3f(const GLchar *name, const glm::vec3 &value, GLboolean useShader){
     if (useShader)
         use();
-    glUniform3f(glGetUniformLocation(id, name), value.x, value.y, value.z);
+    glUniform3f(getUniformLocation(name), value.x, value.y, value.z);
 }//====================================================
 
 void Shader::setVector4f(const GLchar *name, GLfloat x, GLfloat y, GLfloat z, GLfloat w, GLboolean useShader){
     if (useShader)
         use();
-    glUniform4f(glGetUniformLocation(id, name), x, y, z, w);
+    glUniform4f(getUniformLocation(name), x, y, z, w);
 }//====================================================
 
 void Shader::setVector4f(const GLchar *name, const glm::vec4 &value, GLboolean useShader){
     if (useShader)
         use();
-    glUniform4f(glGetUniformLocation(id, name), value.x, value.y, value.z, value.w);
+    glUniform4f(getUniformLocation(name), value.x, value.y, value.z, value.w);
 }//====================================================
 
 void Shader::setMatrix4(const GLchar *name, const glm::mat4 &matrix, GLboolean useShader){
     if (useShader)
         use();
-    glUniformMatrix4fv(glGetUniformLocation(id, name), 1, GL_FALSE, glm::value_ptr(matrix));
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix));
+}//====================================================
+
+void Shader::setFloat(GLint location, GLfloat value, GLboolean useShader){
+    if (useShader)
+        use();
+    glUniform1f(location, value);
+}//====================================================
+
+void Shader::setInteger(GLint location, GLint value, GLboolean useShader){
+    if (useShader)
+        use();
+    glUniform1i(location, value);
+}//====================================================
+
+void Shader::setVector2f(GLint location, GLfloat x, GLfloat y, GLboolean useShader){
+    if (useShader)
+        use();
+    glUniform2f(location, x, y);
+}//====================================================
+
+void Shader::setVector2f(GLint location, const glm::vec2 &value, GLboolean useShader){
+    if (useShader)
+        use();
+    glUniform2f(location, value.x, value.y);
+}//====================================================
+
+void Shader::setVector3f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLboolean useShader){
+    if (useShader)
+        use();
+    glUniform3f(location, x, y, z);
+}//====================================================
+
+void Shader::setVector3f(GLint location, const glm::vec3 &value, GLboolean useShader){
+    if (useShader)
+        use();
+    glUniform3f(location, value.x, value.y, value.z);
+}//====================================================
+
+void Shader::setVector4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w, GLboolean useShader){
+    if (useShader)
+        use();
+    glUniform4f(location, x, y, z, w);
+}//====================================================
+
+void Shader::setVector4f(GLint location, const glm::vec4 &value, GLboolean useShader){
+    if (useShader)
+        use();
+    glUniform4f(location, value.x, value.y, value.z, value.w);
+}//====================================================
+
+void Shader::setMatrix4(GLint location, const glm::mat4 &matrix, GLboolean useShader){
+    if (useShader)
+        use();
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
 }//====================================================
 
 void Shader::checkCompileErrors(GLuint object, std::string type){
@@ -187,5 +302,77 @@ void Shader::checkCompileErrors(GLuint object, std::string type){
     }
 }//====================================================
 
+/**
+ *  @brief Store the location, type, and size of every active uniform and attribute
+ *  @details Called once the program is linked. Uniforms in a uniform block
+ *  have no location and are stored with a location of -1.
+ */
+void Shader::reflect(){
+    uniforms.clear();
+    attributes.clear();
+    warnedUniforms.clear();
+
+    GLint numUniforms = 0, maxNameLen = 0;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &numUniforms);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLen);
+
+    std::vector<GLchar> name(std::max(maxNameLen, 1));
+    for(GLint i = 0; i < numUniforms; i++){
+        ShaderVariable var;
+        GLsizei len = 0;
+        glGetActiveUniform(id, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &len, &(var.size),
+            &(var.type), &(name[0]));
+        var.location = glGetUniformLocation(id, &(name[0]));
+
+        std::string key(&(name[0]), len);
+        uniforms[key] = var;
+
+        // Arrays are reported as "name[0]"; also store them as "name"
+        if(key.size() > 3 && key.compare(key.size() - 3, 3, "[0]") == 0)
+            uniforms[key.substr(0, key.size() - 3)] = var;
+    }
+
+    GLint numAttribs = 0;
+    glGetProgramiv(id, GL_ACTIVE_ATTRIBUTES, &numAttribs);
+    glGetProgramiv(id, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLen);
+
+    name.resize(std::max(maxNameLen, 1));
+    for(GLint i = 0; i < numAttribs; i++){
+        ShaderVariable var;
+        GLsizei len = 0;
+        glGetActiveAttrib(id, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &len, &(var.size),
+            &(var.type), &(name[0]));
+        var.location = glGetAttribLocation(id, &(name[0]));
+        attributes[std::string(&(name[0]), len)] = var;
+    }
+}//====================================================
+
+//-----------------------------------------------------
+//      Camera Uniform Block
+//-----------------------------------------------------
+
+/**
+ *  @brief Upload camera data to a uniform buffer and bind it to CAMERA_BLOCK_BINDING
+ *  @details Every shader that declares the "Camera" block reads from the bound
+ *  buffer, so this is called once per frame rather than once per shader
+ * 
+ *  @param cam camera data
+ *  @param pUBO pointer to the uniform buffer; if it stores zero, a buffer is
+ *  created and its ID is written to pUBO
+ */
+void bindCameraUniforms(const CameraUniforms &cam, GLuint *pUBO){
+    if(*pUBO == 0){
+        glGenBuffers(1, pUBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, *pUBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraUniforms), &cam, GL_DYNAMIC_DRAW);
+    }else{
+        glBindBuffer(GL_UNIFORM_BUFFER, *pUBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraUniforms), &cam);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, *pUBO);
+}//====================================================
+
 }// End of gui namespace
 }// End of Astrohelion namespace
\ No newline at end of file
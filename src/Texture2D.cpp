@@ -48,7 +48,7 @@ Texture2D::Texture2D(){
  *  @param h image height, pixels
  *  @param data image data array
  */
-void Texture2D::generate(GLuint w, GLuint h, unsigned char* data){
+void Texture2D::generate(GLuint w, GLuint h, const unsigned char* data){
     width = w;
     height = h;
 
@@ -0,0 +1,327 @@
+/**
+ *  @file TrajCache.cpp
+ *	@brief Binary, GPU-ready cache of trajectory vertex data
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+ 
+/*
+ *	Astrohelion 
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *	
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TrajCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include "Polyline.hpp"
+
+namespace astrohelion{
+namespace gui{
+
+const char TrajCache::MAGIC[8] = {'A', 'H', 'T', 'R', 'A', 'J', 'C', '\0'};
+const uint32_t TrajCache::VERSION = 3;
+
+/**
+ *  @brief Round a byte offset up to the next multiple of 16
+ *  @param offset byte offset
+ *  @return the aligned offset
+ */
+static uint64_t alignOffset(uint64_t offset){ return (offset + 15) & ~static_cast<uint64_t>(15); }
+
+/**
+ *  @brief Write zeros to a file until the write position reaches an offset
+ * 
+ *  @param fp file pointer
+ *  @param offset desired write position, bytes from the beginning of the file
+ *  @return whether or not the padding was written successfully
+ */
+static bool padFile(FILE *fp, uint64_t offset){
+	long pos = ftell(fp);
+	if(pos < 0 || static_cast<uint64_t>(pos) > offset)
+		return false;
+
+	const char zeros[16] = {0};
+	size_t numPad = static_cast<size_t>(offset - pos);
+	return fwrite(zeros, 1, numPad, fp) == numPad;
+}//====================================================
+
+/**
+ *  @brief Retrieve the size and modification time of a file
+ * 
+ *  @param path filepath
+ *  @param size receives the size of the file, bytes
+ *  @param modTime receives the modification time of the file, seconds since epoch
+ *  @return whether or not the file exists and could be queried
+ */
+static bool getFileStats(const char* path, uint64_t *size, int64_t *modTime){
+#ifndef _WIN32
+	struct stat st;
+	if(stat(path, &st) != 0)
+		return false;
+
+	*size = static_cast<uint64_t>(st.st_size);
+	*modTime = static_cast<int64_t>(st.st_mtime);
+	return true;
+#else
+	(void) path;
+	(void) size;
+	(void) modTime;
+	return false;
+#endif
+}//====================================================
+
+//-----------------------------------------------------
+//      *structors
+//-----------------------------------------------------
+
+/**
+ *  @brief Construct an empty cache; nothing is mapped
+ */
+TrajCache::TrajCache(){}
+
+/**
+ *  @brief Unmap the cache file
+ */
+TrajCache::~TrajCache(){
+	close();
+}//====================================================
+
+//-----------------------------------------------------
+//      Action Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Map a cache file into memory
+ *  @details The file is rejected if it is missing, truncated, written by a different
+ *  format version, or older than the source trajectory file. The operating system is
+ *  advised to page in the data right away so that a subsequent upload to the GPU
+ *  does not stall on disk reads.
+ * 
+ *  @param cachePath filepath to the cache file
+ *  @param srcPath filepath to the trajectory file the cache was created from
+ *  @return whether or not a valid cache was mapped
+ */
+bool TrajCache::open(const char* cachePath, const char* srcPath){
+	close();
+
+#ifndef _WIN32
+	uint64_t srcSize = 0;
+	int64_t srcModTime = 0;
+	if(!getFileStats(srcPath, &srcSize, &srcModTime))
+		return false;
+
+	int fd = ::open(cachePath, O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TrajCacheHeader)){
+		::close(fd);
+		return false;
+	}
+
+	size_t size = static_cast<size_t>(st.st_size);
+	void *pMap = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);	// The mapping remains valid after the file is closed
+
+	if(pMap == MAP_FAILED)
+		return false;
+
+	TrajCacheHeader h;
+	std::memcpy(&h, pMap, sizeof(h));
+
+	bool valid = std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+		h.version == VERSION &&
+		h.vertexStride == Polyline::VERTEX_STRIDE &&
+		h.srcSize == srcSize && h.srcModTime == srcModTime &&
+		h.numVertices == h.numPoints + 2 &&
+		h.vertexOffset + h.vertexStride*h.numVertices*sizeof(float) <= size &&
+		(h.epochOffset == 0 || h.epochOffset + h.numPoints*sizeof(double) <= size);
+
+	if(!valid){
+		munmap(pMap, size);
+		return false;
+	}
+
+	madvise(pMap, size, MADV_WILLNEED);
+
+	pData = pMap;
+	dataSize = size;
+	header = h;
+	return true;
+#else
+	(void) cachePath;
+	(void) srcPath;
+	return false;
+#endif
+}//====================================================
+
+/**
+ *  @brief Unmap the cache file, if one is mapped
+ */
+void TrajCache::close(){
+#ifndef _WIN32
+	if(pData)
+		munmap(pData, dataSize);
+#endif
+	pData = nullptr;
+	dataSize = 0;
+	header = TrajCacheHeader();
+}//====================================================
+
+/**
+ *  @brief Write a cache file for a set of trajectory points
+ * 
+ *  @param cachePath filepath to the cache file
+ *  @param srcPath filepath to the trajectory file the points were loaded from
+ *  @param pts trajectory points (x, y, z for each point)
+ *  @param epochs epoch of each point; leave empty to omit the epochs
+ *  @throws std::runtime_error if the points do not form a line or the file cannot be written
+ */
+void TrajCache::write(const char* cachePath, const char* srcPath, const std::vector<float> &pts,
+	const std::vector<double> &epochs){
+
+	std::vector<float> verts;
+	Polyline::buildVertexData(pts, verts);
+
+	writeVertices(cachePath, srcPath, verts, epochs);
+}//====================================================
+
+/**
+ *  @brief Write a cache file for a line whose vertex data has already been built
+ *  @details The file is written to a temporary path and then renamed so that a
+ *  partially written file is never mistaken for a valid cache.
+ * 
+ *  @param cachePath filepath to the cache file
+ *  @param srcPath filepath to the trajectory file the points were loaded from
+ *  @param verts vertex array built by Polyline::buildVertexData()
+ *  @param epochs epoch of each point; leave empty to omit the epochs
+ *  @throws std::runtime_error if the data do not form a line, the number of epochs
+ *  does not match the number of points, or the file cannot be written
+ */
+void TrajCache::writeVertices(const char* cachePath, const char* srcPath, const std::vector<float> &verts,
+	const std::vector<double> &epochs){
+
+	if(verts.size() % Polyline::VERTEX_STRIDE != 0 || verts.size() < Polyline::VERTEX_STRIDE*(2 + 2))
+		throw std::runtime_error("TrajCache::writeVertices: Data do not describe a line");
+
+	if(!epochs.empty() && epochs.size() != verts.size()/Polyline::VERTEX_STRIDE - 2)
+		throw std::runtime_error("TrajCache::writeVertices: Number of epochs does not match the number of points");
+
+	TrajCacheHeader h {};
+	if(!getFileStats(srcPath, &h.srcSize, &h.srcModTime))
+		throw std::runtime_error("TrajCache::writeVertices: Could not read source file attributes");
+
+	std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+	h.version = VERSION;
+	h.vertexStride = Polyline::VERTEX_STRIDE;
+	h.numVertices = verts.size()/Polyline::VERTEX_STRIDE;
+	h.numPoints = h.numVertices - 2;
+	h.vertexOffset = alignOffset(sizeof(TrajCacheHeader));
+	h.epochOffset = epochs.empty() ? 0 : alignOffset(h.vertexOffset + verts.size()*sizeof(float));
+
+	std::string tmpPath = std::string(cachePath) + ".tmp";
+	FILE *fp = fopen(tmpPath.c_str(), "wb");
+	if(!fp)
+		throw std::runtime_error("TrajCache::writeVertices: Could not open cache file for writing");
+
+	bool ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+	ok = ok && padFile(fp, h.vertexOffset) && fwrite(&(verts[0]), sizeof(float), verts.size(), fp) == verts.size();
+	if(!epochs.empty())
+		ok = ok && padFile(fp, h.epochOffset) && fwrite(&(epochs[0]), sizeof(double), epochs.size(), fp) == epochs.size();
+	ok = (fclose(fp) == 0) && ok;
+
+	if(!ok || std::rename(tmpPath.c_str(), cachePath) != 0){
+		std::remove(tmpPath.c_str());
+		throw std::runtime_error("TrajCache::writeVertices: Failed to write cache file");
+	}
+}//====================================================
+
+//-----------------------------------------------------
+//      Set and Get Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Retrieve the cache filepath associated with a trajectory file
+ *  @param srcPath filepath to the trajectory file
+ *  @return the cache filepath
+ */
+std::string TrajCache::getCachePath(const char* srcPath){
+	return std::string(srcPath) + ".glcache";
+}//====================================================
+
+/**
+ *  @brief Retrieve the number of trajectory points
+ *  @return the number of trajectory points
+ */
+size_t TrajCache::getNumPoints() const { return header.numPoints; }
+
+/**
+ *  @brief Retrieve the number of vertices, including adjacency vertices
+ *  @return the number of vertices
+ */
+size_t TrajCache::getNumVertices() const { return header.numVertices; }
+
+/**
+ *  @brief Retrieve the number of floats stored for each vertex
+ *  @return the number of floats stored for each vertex
+ */
+unsigned int TrajCache::getVertexStride() const { return header.vertexStride; }
+
+/**
+ *  @brief Retrieve a pointer to the epoch of each trajectory point
+ *  @return a pointer to the epochs (one per point), or nullptr if no cache is
+ *  mapped or the cache does not store epochs
+ */
+const double* TrajCache::getEpochs() const{
+	return pData && header.epochOffset != 0 ?
+		reinterpret_cast<const double*>(static_cast<const char*>(pData) + header.epochOffset) : nullptr;
+}//====================================================
+
+/**
+ *  @brief Retrieve a pointer to the trajectory points
+ *  @details The points follow the leading adjacency vertex in the vertex array
+ *  @return a pointer to the trajectory points (x, y, z for each point),
+ *  or nullptr if no cache is mapped
+ */
+const float* TrajCache::getPoints() const{
+	return pData ? getVertices() + header.vertexStride : nullptr;
+}//====================================================
+
+/**
+ *  @brief Retrieve a pointer to the vertex data
+ *  @return a pointer to the vertex data, or nullptr if no cache is mapped
+ */
+const float* TrajCache::getVertices() const{
+	return pData ? reinterpret_cast<const float*>(static_cast<const char*>(pData) + header.vertexOffset) : nullptr;
+}//====================================================
+
+}// End of gui namespace
+}// End of astrohelion namespace
@@ -0,0 +1,263 @@
+/**
+ *  @file TrajExtract.cpp
+ *	@brief Bulk conversion of trajectory states to render-ready arrays
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+ 
+/*
+ *	Astrohelion 
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *	
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TrajExtract.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	#include <arm_neon.h>
+#endif
+
+#include "astrohelion/Traj_bc4bp.hpp"
+
+namespace astrohelion{
+namespace gui{
+
+/** Number of nodes whose state pointers are gathered before they are narrowed */
+static const size_t EXTRACT_BLOCK = 256;
+
+/** Do not spawn a thread for fewer than this many nodes */
+static const int MIN_NODES_PER_THREAD = 16384;
+
+/**
+ *  @brief Append a single marker
+ * 
+ *  @param pts packed positions
+ *  @param ix index of the marker position within <tt>pts</tt>
+ *  @param rgba marker color
+ *  @param pMarkers marker set to append to
+ */
+static void pushMarker(const float *pts, int ix, const float *rgba, TrajMarkers *pMarkers){
+	pMarkers->points.insert(pMarkers->points.end(), pts + 3*ix, pts + 3*ix + 3);
+	pMarkers->colors.insert(pMarkers->colors.end(), rgba, rgba + 4);
+}//====================================================
+
+//-----------------------------------------------------
+//      Function Definitions
+//-----------------------------------------------------
+
+/**
+ *  @brief Narrow the position components of a set of states to single precision
+ *  @details The first three elements (x, y, z) of each state are converted with
+ *  SSE2 (x86) or NEON (AArch64) instructions when available, and with scalar code
+ *  otherwise. The output is packed: three floats per state.
+ * 
+ *  @param states array of pointers to states; each state must have at least three elements
+ *  @param n number of states
+ *  @param dst output array with space for 3*n floats
+ */
+void narrowPositions(const double* const* states, size_t n, float* dst){
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	// Two states per iteration: convert (x,y) pairs together and the z components together
+	for(; i + 2 <= n; i += 2){
+		const double *q0 = states[i], *q1 = states[i+1];
+		__m128 xy0 = _mm_cvtpd_ps(_mm_loadu_pd(q0));		// [x0, y0, 0, 0]
+		__m128 xy1 = _mm_cvtpd_ps(_mm_loadu_pd(q1));		// [x1, y1, 0, 0]
+		__m128 zz = _mm_cvtpd_ps(_mm_set_pd(q1[2], q0[2]));	// [z0, z1, 0, 0]
+
+		// Pack as [x0, y0, z0, x1] and [y1, z1]
+		__m128 lo = _mm_movelh_ps(xy0, _mm_unpacklo_ps(zz, xy1));
+		__m128 hi = _mm_unpacklo_ps(_mm_shuffle_ps(xy1, xy1, _MM_SHUFFLE(1,1,1,1)),
+			_mm_shuffle_ps(zz, zz, _MM_SHUFFLE(1,1,1,1)));
+
+		_mm_storeu_ps(dst + 3*i, lo);
+		_mm_storel_pi(reinterpret_cast<__m64*>(dst + 3*i + 4), hi);
+	}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	for(; i < n; i++){
+		vst1_f32(dst + 3*i, vcvt_f32_f64(vld1q_f64(states[i])));
+		dst[3*i+2] = static_cast<float>(states[i][2]);
+	}
+#endif
+
+	// Scalar remainder (or the entire array without SIMD support)
+	for(; i < n; i++){
+		dst[3*i+0] = static_cast<float>(states[i][0]);
+		dst[3*i+1] = static_cast<float>(states[i][1]);
+		dst[3*i+2] = static_cast<float>(states[i][2]);
+	}
+}//====================================================
+
+/**
+ *  @brief Narrow the positions of a contiguous range of nodes
+ *  @details State pointers are gathered by reference in small blocks, so no
+ *  per-node vectors are allocated
+ * 
+ *  @param arc trajectory
+ *  @param first index of the first node
+ *  @param count number of nodes
+ *  @param dst output array with space for 3*count floats
+ */
+static void extractRange(const Traj_bc4bp &arc, int first, int count, float *dst){
+	const double *states[EXTRACT_BLOCK];
+
+	for(int b = 0; b < count; b += EXTRACT_BLOCK){
+		int nBlock = std::min(static_cast<int>(EXTRACT_BLOCK), count - b);
+		for(int i = 0; i < nBlock; i++){
+			states[i] = &(arc.getNodeRefByIx_const(first + b + i).getStateRef_const()[0]);
+		}
+
+		narrowPositions(states, nBlock, dst + 3*b);
+	}
+}//====================================================
+
+/**
+ *  @brief Extract the positions of a range of trajectory nodes into a preallocated buffer
+ *  @details The range is optionally split across several threads; each thread
+ *  writes a disjoint part of <tt>dst</tt>. Markers for the nodes in the range are
+ *  appended to <tt>pMarkers</tt> from the narrowed data, so the trajectory is only
+ *  read once.
+ * 
+ *  @param arc trajectory
+ *  @param first index of the first node to extract
+ *  @param count number of nodes to extract
+ *  @param dst output array with space for 3*count floats
+ *  @param pMarkers pointer to a marker set to append to; set to nullptr to skip markers
+ *  @param numThreads maximum number of threads to use; zero selects the hardware concurrency
+ *  @throws std::out_of_range if the range extends outside the trajectory
+ */
+void extractPositions(const Traj_bc4bp &arc, int first, int count, float *dst, TrajMarkers *pMarkers,
+	unsigned int numThreads){
+
+	if(first < 0 || count < 0 || first + count > arc.getNumNodes())
+		throw std::out_of_range("extractPositions: Node range is outside the trajectory");
+
+	if(numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	numThreads = std::min(numThreads, static_cast<unsigned int>(std::max(1, count/MIN_NODES_PER_THREAD)));
+
+	if(numThreads <= 1){
+		extractRange(arc, first, count, dst);
+	}else{
+		std::vector<std::thread> workers;
+		int perThread = (count + numThreads - 1)/numThreads;
+		for(unsigned int t = 0; t < numThreads; t++){
+			int t0 = t*perThread;
+			int nT = std::min(perThread, count - t0);
+			if(nT <= 0)
+				break;
+
+			workers.push_back(std::thread(extractRange, std::cref(arc), first + t0, nT, dst + 3*t0));
+		}
+
+		for(auto &w : workers)
+			w.join();
+	}
+
+	if(pMarkers)
+		appendMarkers(dst, first, count, arc.getNumNodes(), pMarkers);
+}//====================================================
+
+/**
+ *  @brief Extract the positions of every node in a trajectory
+ * 
+ *  @param arc trajectory
+ *  @param pts receives the positions (x, y, z for each node); the vector is
+ *  resized once and any previous contents are overwritten
+ *  @param pMarkers pointer to a marker set to append to; set to nullptr to skip markers
+ *  @param numThreads maximum number of threads to use; zero selects the hardware concurrency
+ */
+void extractPositions(const Traj_bc4bp &arc, std::vector<float> &pts, TrajMarkers *pMarkers,
+	unsigned int numThreads){
+
+	int n = arc.getNumNodes();
+	pts.resize(3*n);
+	if(n > 0)
+		extractPositions(arc, 0, n, &(pts[0]), pMarkers, numThreads);
+}//====================================================
+
+/**
+ *  @brief Extract the epoch of every node in a trajectory
+ *  @details Epochs are kept in double precision; they are typically much
+ *  larger than the spacing between neighboring nodes
+ * 
+ *  @param arc trajectory
+ *  @param epochs receives the epoch of each node; any previous contents are discarded
+ */
+void extractEpochs(const Traj_bc4bp &arc, std::vector<double> &epochs){
+	int n = arc.getNumNodes();
+	epochs.resize(n);
+	for(int i = 0; i < n; i++){
+		epochs[i] = arc.getEpochByIx(i);
+	}
+}//====================================================
+
+/**
+ *  @brief Retrieve the mutex that serializes reading trajectory files
+ *  @details The Astrohelion readers (matio, and the SPICE-backed BodyData
+ *  used by the system data) are not reentrant, so every thread that reads a
+ *  file and constructs a SysData_bc4bp or Traj_bc4bp from it must hold this
+ *  mutex while doing so. Extracting data from a trajectory that has already
+ *  been constructed does not require the mutex.
+ *  @return a reference to the process-wide mutex
+ */
+std::mutex& getTrajReadMutex(){
+	static std::mutex readMutex;
+	return readMutex;
+}//====================================================
+
+/**
+ *  @brief Append markers for a range of nodes whose positions have been extracted
+ *  @details Markers are placed at the first node, the final node, and, if
+ *  TrajMarkers::nodeStride is nonzero, at every nodeStride-th node in between.
+ * 
+ *  @param pts positions of the nodes in the range (x, y, z for each node)
+ *  @param first index of the first node in the range
+ *  @param count number of nodes in the range
+ *  @param numNodes total number of nodes in the trajectory
+ *  @param pMarkers marker set to append to
+ */
+void appendMarkers(const float *pts, int first, int count, int numNodes, TrajMarkers *pMarkers){
+	int last = first + count;		// One past the final node in the range
+
+	if(first == 0 && count > 0)
+		pushMarker(pts, 0, pMarkers->startColor, pMarkers);
+
+	if(pMarkers->nodeStride > 0){
+		int stride = static_cast<int>(pMarkers->nodeStride);
+		for(int i = ((first + stride - 1)/stride)*stride; i < last; i += stride){
+			if(i != 0 && i != numNodes - 1)
+				pushMarker(pts, i - first, pMarkers->nodeColor, pMarkers);
+		}
+	}
+
+	if(last == numNodes && numNodes > 1 && count > 0)
+		pushMarker(pts, numNodes - 1 - first, pMarkers->endColor, pMarkers);
+}//====================================================
+
+}	// END of gui namespace
+}	// END of astrohelion namespace
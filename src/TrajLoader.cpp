@@ -0,0 +1,339 @@
+/**
+ *  @file TrajLoader.cpp
+ *	@brief Load trajectory data on a background thread
+ *
+ *	@author Andrew Cox
+ *	@version October 17, 2026
+ *	@copyright GNU GPL v3.0
+ */
+ 
+/*
+ *	Astrohelion 
+ *	Copyright 2016, Andrew Cox; Protected under the GNU GPL v3.0
+ *	
+ *	This file is part of Astrohelion
+ *
+ *  Astrohelion is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Astrohelion is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Astrohelion.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TrajLoader.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+
+#include "TrajCache.hpp"
+#include "TrajExtract.hpp"
+
+#include "astrohelion/SysData_bc4bp.hpp"
+#include "astrohelion/Traj_bc4bp.hpp"
+
+namespace astrohelion{
+namespace gui{
+
+//-----------------------------------------------------
+//      *structors
+//-----------------------------------------------------
+
+/**
+ *  @brief Construct a default loader; no thread is started
+ */
+TrajLoader::TrajLoader() : numNodes(-1), numLoaded(0), bDone(false), bAbort(false) {}
+
+/**
+ *  @brief Destruct the loader, stopping the worker thread if it is running
+ */
+TrajLoader::~TrajLoader(){
+	stop();
+}//====================================================
+
+//-----------------------------------------------------
+//      Action Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Begin loading a trajectory on a worker thread
+ *  @details Any load that is already in progress is stopped first.
+ * 
+ *  @param filepath Path to the trajectory file (a BC4BP trajectory saved by Astrohelion)
+ *  @param chunkSize Number of nodes delivered in each chunk
+ */
+void TrajLoader::start(const char* filepath, unsigned int chunkSize){
+	stop();
+
+	{
+		std::lock_guard<std::mutex> lock(dataMutex);
+		chunks.clear();
+		markers = TrajMarkers();
+		epochs.clear();
+		lodLevels.clear();
+		lodIx.clear();
+		errMsg.clear();
+		pCache.reset();
+	}
+
+	numNodes = -1;
+	numLoaded = 0;
+	bDone = false;
+	bAbort = false;
+
+	if(chunkSize == 0)
+		chunkSize = 1;
+
+	worker = std::thread(&TrajLoader::run, this, std::string(filepath), chunkSize);
+}//====================================================
+
+/**
+ *  @brief Stop the worker thread and wait for it to exit
+ *  @details The worker checks for the stop request between chunks, so
+ *  this function may block until the trajectory file has been parsed.
+ */
+void TrajLoader::stop(){
+	bAbort = true;
+	if(worker.joinable())
+		worker.join();
+}//====================================================
+
+/**
+ *  @brief Retrieve the oldest chunk of node positions that has not been retrieved yet
+ * 
+ *  @param chunk Vector that receives the positions (x, y, z for each node);
+ *  any previous contents are discarded
+ *  @return whether or not a chunk was available
+ */
+bool TrajLoader::popChunk(std::vector<float> &chunk){
+	std::lock_guard<std::mutex> lock(dataMutex);
+	if(chunks.empty())
+		return false;
+
+	chunk.swap(chunks.front());
+	chunks.pop_front();
+	return true;
+}//====================================================
+
+/**
+ *  @brief Retrieve the trajectory cache mapped by the worker thread
+ *  @details A cache is only delivered if a valid one existed when the load
+ *  started; in that case, no chunks are delivered via popChunk().
+ *  @return the mapped cache, or nullptr if no cache is waiting to be retrieved
+ */
+std::shared_ptr<TrajCache> TrajLoader::takeCache(){
+	std::lock_guard<std::mutex> lock(dataMutex);
+	std::shared_ptr<TrajCache> cache = pCache;
+	pCache.reset();
+	return cache;
+}//====================================================
+
+/**
+ *  @brief Retrieve the levels of detail computed by the worker thread
+ *  @details The levels are available once isDone() returns true, and are
+ *  passed to Polyline::setLOD() once every chunk has been appended
+ * 
+ *  @param levels Receives the levels, ordered from finest to coarsest; any
+ *  previous contents are discarded
+ *  @param ix Receives the index array of the levels; any previous contents
+ *  are discarded
+ *  @return whether or not any levels were available
+ */
+bool TrajLoader::takeLOD(std::vector<LineLOD> &levels, std::vector<unsigned int> &ix){
+	std::lock_guard<std::mutex> lock(dataMutex);
+	levels.clear();
+	ix.clear();
+	levels.swap(lodLevels);
+	ix.swap(lodIx);
+	return !levels.empty();
+}//====================================================
+
+//-----------------------------------------------------
+//      Set and Get Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Retrieve the error message from the worker thread
+ *  @return the error message, or an empty string if no error has occurred
+ */
+std::string TrajLoader::getError() const{
+	std::lock_guard<std::mutex> lock(dataMutex);
+	return errMsg;
+}//====================================================
+
+/**
+ *  @brief Retrieve the epoch of each node
+ *  @details Epochs are not delivered for a trajectory loaded from a cache;
+ *  they are available from the cache itself (see TrajCache::getEpochs())
+ *  @return the epochs, or an empty vector if the trajectory has not been
+ *  fully parsed
+ */
+std::vector<double> TrajLoader::getEpochs() const{
+	std::lock_guard<std::mutex> lock(dataMutex);
+	return epochs;
+}//====================================================
+
+/**
+ *  @brief Retrieve the markers produced while extracting the trajectory
+ *  @return the markers (the first and last nodes), or an empty marker set if
+ *  the trajectory has not been fully loaded
+ */
+TrajMarkers TrajLoader::getMarkers() const{
+	std::lock_guard<std::mutex> lock(dataMutex);
+	return markers;
+}//====================================================
+
+/**
+ *  @brief Retrieve the number of nodes extracted so far
+ *  @return the number of nodes extracted so far
+ */
+int TrajLoader::getNumLoaded() const { return numLoaded; }
+
+/**
+ *  @brief Retrieve the total number of nodes in the trajectory
+ *  @return the number of nodes in the trajectory, or -1 if the file
+ *  has not been parsed yet
+ */
+int TrajLoader::getNumNodes() const { return numNodes; }
+
+/**
+ *  @brief Determine whether the worker thread has finished
+ *  @details Chunks may still be waiting to be retrieved via popChunk()
+ *  @return whether the worker thread has finished
+ */
+bool TrajLoader::isDone() const { return bDone; }
+
+/**
+ *  @brief Determine whether the worker has finished and all chunks have been retrieved
+ *  @return whether the worker has finished and all chunks have been retrieved
+ */
+bool TrajLoader::isFinished() const{
+	if(!bDone)
+		return false;
+
+	std::lock_guard<std::mutex> lock(dataMutex);
+	return chunks.empty() && !pCache;
+}//====================================================
+
+/**
+ *  @brief Set whether or not trajectory caches are read and written
+ *  @details This setting applies to loads started after it is changed
+ *  @param b whether or not trajectory caches are read and written
+ */
+void TrajLoader::setUseCache(bool b){ bUseCache = b; }
+
+//-----------------------------------------------------
+//      Utility Functions
+//-----------------------------------------------------
+
+/**
+ *  @brief Worker thread function: parse the file and extract node positions
+ * 
+ *  @param filepath Path to the trajectory file
+ *  @param chunkSize Number of nodes in each chunk
+ */
+void TrajLoader::run(std::string filepath, unsigned int chunkSize){
+	std::string cachePath = TrajCache::getCachePath(filepath.c_str());
+	try{
+		if(bUseCache){
+			std::shared_ptr<TrajCache> cache(new TrajCache());
+			if(cache->open(cachePath.c_str(), filepath.c_str())){
+				int n = static_cast<int>(cache->getNumPoints());
+				const float *pts = cache->getPoints();
+
+				numNodes = n;
+				numLoaded = n;
+
+				std::vector<LineLOD> newLevels;
+				std::vector<unsigned int> newIx;
+				Polyline::computeLOD(pts, static_cast<size_t>(n), newLevels, newIx);
+
+				std::lock_guard<std::mutex> lock(dataMutex);
+				appendMarkers(pts, 0, n, n, &markers);
+				lodLevels.swap(newLevels);
+				lodIx.swap(newIx);
+				pCache = cache;
+				bDone = true;
+				return;
+			}
+		}
+
+		// The file readers are not reentrant; a SceneImporter may be reading files too
+		std::unique_ptr<SysData_bc4bp> pSys;
+		std::unique_ptr<Traj_bc4bp> pArc;
+		{
+			std::lock_guard<std::mutex> lock(getTrajReadMutex());
+			pSys.reset(new SysData_bc4bp(filepath.c_str()));
+			pArc.reset(new Traj_bc4bp(filepath.c_str(), pSys.get()));
+		}
+		const Traj_bc4bp &arc = *pArc;
+
+		int n = arc.getNumNodes();
+		numNodes = n;
+
+		// Positions are extracted in bulk straight into the full array, which the
+		// levels of detail and the cache are built from; each chunk is copied from it
+		std::vector<float> allPts(3*n);
+
+		TrajMarkers newMarkers;
+		std::vector<float> chunk;
+		for(int i = 0; i < n && !bAbort; i += chunkSize){
+			int count = std::min(static_cast<int>(chunkSize), n - i);
+			extractPositions(arc, i, count, &(allPts[3*i]), &newMarkers, 0);
+			chunk.assign(allPts.begin() + 3*i, allPts.begin() + 3*(i + count));
+			pushChunk(chunk);
+		}
+
+		std::vector<double> newEpochs;
+		if(!bAbort){
+			extractEpochs(arc, newEpochs);
+
+			std::vector<LineLOD> newLevels;
+			std::vector<unsigned int> newIx;
+			Polyline::computeLOD(allPts.empty() ? nullptr : &(allPts[0]), static_cast<size_t>(n), newLevels, newIx);
+
+			std::lock_guard<std::mutex> lock(dataMutex);
+			markers = newMarkers;
+			epochs = newEpochs;
+			lodLevels.swap(newLevels);
+			lodIx.swap(newIx);
+		}
+
+		// Write a cache so the next load can skip parsing; failure here is not fatal
+		if(bUseCache && n > 1 && !bAbort){
+			try{
+				TrajCache::write(cachePath.c_str(), filepath.c_str(), allPts, newEpochs);
+			}catch(std::exception &e){
+				printf("TrajLoader: Could not write trajectory cache: %s\n", e.what());
+			}
+		}
+	}catch(std::exception &e){
+		std::lock_guard<std::mutex> lock(dataMutex);
+		errMsg = e.what();
+	}
+
+	bDone = true;
+}//====================================================
+
+/**
+ *  @brief Move a chunk into the queue
+ *  @param chunk Chunk to enqueue; it is left empty
+ */
+void TrajLoader::pushChunk(std::vector<float> &chunk){
+	numLoaded += chunk.size()/3;
+
+	std::lock_guard<std::mutex> lock(dataMutex);
+	chunks.push_back(std::vector<float>());
+	chunks.back().swap(chunk);
+}//====================================================
+
+}// End of gui namespace
+}// End of astrohelion namespace
@@ -97,8 +97,9 @@ Window::~Window(){
     if (imgui_VAO) glDeleteVertexArrays(1, &imgui_VAO);
     if (imgui_VBO) glDeleteBuffers(1, &imgui_VBO);
     if (imgui_EBO) glDeleteBuffers(1, &imgui_EBO);
+    if (cameraUBO) glDeleteBuffers(1, &cameraUBO);
 
-    imgui_VAO = imgui_VBO = imgui_EBO = 0;
+    imgui_VAO = imgui_VBO = imgui_EBO = cameraUBO = 0;
 
     ImGui::SetCurrentContext(imguiContext);
 
@@ -350,6 +351,25 @@ void Window::preDraw(){
     ImGui::NewFrame();
 }//====================================================
 
+/**
+ *  @brief Upload the camera of this window to the "Camera" uniform block
+ *  @details The view and projection matrices and the viewport size are
+ *  written to a single uniform buffer, which is bound to CAMERA_BLOCK_BINDING.
+ *  Every shader declares the block, so this is the only camera data uploaded
+ *  each frame, regardless of the number of shaders that draw.
+ */
+void Window::uploadCameraUniforms(){
+    CameraUniforms cam;
+    cam.view = view;
+    cam.projection = projection;
+    cam.viewProj = projection*view;
+    cam.viewportSize = glm::vec2(width, height);
+    cam.time = lastFrameTime;
+
+    // Windows may share a context, so the binding is restored every frame
+    bindCameraUniforms(cam, &cameraUBO);
+}//====================================================
+
 /**
  *  @brief Override this class to implement your own graphics
  */
@@ -371,9 +391,12 @@ void Window::postDraw(){
 
 /**
  *  @brief Call this function from the event loop to render this window
+ *  @details The camera uniforms are uploaded from the view and projection
+ *  matrices set by update() before draw() is called
  */
 void Window::render(){
     preDraw();
+    uploadCameraUniforms();
     draw();
     postDraw();
 }//====================================================
@@ -529,6 +552,7 @@ void Window::copyMe(const Window &w){
 	imgui_VAO = w.imgui_VAO;
 	imgui_VBO = w.imgui_VBO;
 	imgui_EBO = w.imgui_EBO;
+	cameraUBO = w.cameraUBO;
 
 	frame_dt = w.frame_dt;
 	lastFrameTime = w.lastFrameTime;